@@ -10,19 +10,42 @@
 
 #include "DebugInfo.h"
 
-void DebugInfo::paint(juce::Graphics& g) {
-    if (!debugSynth) return;
+namespace {
+    // what paint shows: whole microseconds and loads in tenths of a percent
+    int displayedMicros(float micros) { return juce::roundToInt(micros); }
+    int displayedLoad(float load) { return juce::roundToInt(load * 1000.0f); }
+}
+
+bool DebugInfo::refresh() {
+    if (!performance) return false;
+
+    // the raw times change every block, only a change that shows up on screen is worth a repaint
+    auto stats = performance->read();
+    bool changed = displayedMicros(stats.renderMicros) != displayedMicros(shown.renderMicros)
+                || displayedLoad(stats.load) != displayedLoad(shown.load)
+                || displayedLoad(stats.peakLoad) != displayedLoad(shown.peakLoad)
+                || stats.xrunRisks != shown.xrunRisks || stats.activeVoices != shown.activeVoices
+                || stats.polyphony != shown.polyphony || stats.activeLayers != shown.activeLayers;
 
-    int totalVoices = debugSynth->getNumVoices();
-    int activeVoices = 0;
+    if (changed) shown = stats;
+    return changed;
+}
 
-    for (int i = 0; i < debugSynth->getNumVoices(); i++) {
-        if (debugSynth->getVoice(i)->isVoiceActive())
-            activeVoices++;
-    }
+void DebugInfo::paint(juce::Graphics& g) {
+    if (!performance) return;
+
+    const auto& stats = shown;
+    auto percent = [](float load) { return juce::String(displayedLoad(load) / 10.0f, 1) + "%"; };
 
-    std::string debugInfo = "Voices: " + std::to_string(totalVoices);
-    debugInfo += "\nActive: " + std::to_string(activeVoices);
+    juce::String debugInfo = "Voices: " + juce::String(stats.activeVoices) + " / " + juce::String(stats.polyphony);
+    debugInfo << "\nLayers: " << stats.activeLayers;
+    debugInfo << "\nRender: " << displayedMicros(stats.renderMicros) << " us";
+    debugInfo << "\nLoad: " << percent(stats.load) << " (peak " << percent(stats.peakLoad) << ")";
+    debugInfo << "\nXrun risk: " << (int)stats.xrunRisks;
     g.setColour(juce::Colours::white.withAlpha(0.1f));
     g.drawMultiLineText(debugInfo, 2, 22, 200);
-}
\ No newline at end of file
+}
+
+void DebugInfo::mouseDown(const juce::MouseEvent&) {
+    if (performance) performance->resetPeak();
+}
@@ -11,15 +11,21 @@
 #pragma once
 
 #include <JuceHeader.h>
+#include "PerformanceCounters.h"
 
-class DebugInfo : public juce::AnimatedAppComponent {
+// Shows what the audio thread measured, click it to reset the peak load
+class DebugInfo : public juce::Component {
 public:
-    void update() override {};
     void paint(juce::Graphics& g) override;
-    void init(juce::Synthesiser* synth) {
-        debugSynth = synth;
+    void mouseDown(const juce::MouseEvent&) override;
+    void init(PerformanceCounters* counters) {
+        performance = counters;
     }
 
+    // Reads the counters, returns whether anything shown has changed
+    bool refresh();
+
 private:
-    juce::Synthesiser* debugSynth;
-};
\ No newline at end of file
+    PerformanceCounters* performance = nullptr;
+    PerformanceSnapshot shown;
+};
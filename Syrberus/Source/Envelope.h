@@ -10,161 +10,321 @@
 
 #pragma once
 #include <JuceHeader.h>
+#include "SeqLock.h"
 
 namespace dubu {
 
-    // UI? 
+    // One stage of the envelope: a curve from wherever the level is to endLevel,
+    // over `seconds`. Every stage heads for a target slightly past endLevel so the
+    // exponential lands exactly on endLevel at the end of the stage.
+    struct EnvelopeSegment {
+        float seconds = 0.0f;
+        float endLevel = 0.0f;
+        float ratio = 1.0f;     // how far past endLevel the curve aims, smaller is more exponential
+        float steepness = 0.0f; // log((1 + ratio) / ratio)
+
+        void set(float newSeconds, float newEndLevel, float newRatio) {
+            seconds = newSeconds;
+            endLevel = newEndLevel;
+            ratio = newRatio;
+            steepness = std::log((1.0f + ratio) / ratio);
+        }
+
+        float getTarget(float startLevel) const {
+            return endLevel + (endLevel - startLevel) * ratio;
+        }
+
+        // The level x of the way (0 to 1) through the stage. Envelope renders the
+        // same curve recursively, one step being std::exp(-steepness / samples)
+        float getValueAt(float startLevel, float x) const {
+            float target = getTarget(startLevel);
+            return target + (startLevel - target) * std::exp(-steepness * x);
+        }
+    };
+
+    // The envelope shape, shared by the voices and the editor
     class EnvelopeGraph {
     public:
-        float attack, decay, sustain, release, timeDecayEnds, timeReleaseEnds;
+        enum Stage {
+            DELAY, ATTACK, HOLD, DECAY, SUSTAIN, RELEASE, NUM_STAGES
+        };
+
+        float delay = 0.0f, attack = 0.0f, hold = 0.0f, decay = 0.0f, sustain = 1.0f, release = 0.0f;
+
+        EnvelopeGraph() {
+            setParams(0.0f, 0.0f, 0.0f, 0.0f, 1.0f, 0.0f);
+        }
 
-        float getMaxLengthInSeconds() { return maxLength; };
+        float getMaxLengthInSeconds() const { return maxLength; };
 
-        void setParams(float attack, float decay, float sustain, float release) {
+        void setParams(float delay, float attack, float hold, float decay, float sustain, float release) {
+            this->delay = delay;
             this->attack = attack;
+            this->hold = hold;
             this->decay = decay;
             this->sustain = sustain;
             this->release = release;
-            this->timeDecayEnds = attack + decay;
-            this->timeReleaseEnds = timeDecayEnds + release;
 
-            if(attack < 0.001f)
+            // delay and hold are flat, so they can be skipped entirely when zero
+            segments[DELAY].set(delay, 0.0f, DECAY_RATIO);
+            segments[ATTACK].set(juce::jmax(attack, MIN_SEGMENT_SECONDS), 1.0f, ATTACK_RATIO);
+            segments[HOLD].set(hold, 1.0f, DECAY_RATIO);
+            segments[DECAY].set(juce::jmax(decay, MIN_SEGMENT_SECONDS), sustain, DECAY_RATIO);
+            segments[SUSTAIN].set(0.0f, sustain, DECAY_RATIO);
+            segments[RELEASE].set(juce::jmax(release, MIN_SEGMENT_SECONDS), 0.0f, DECAY_RATIO);
+
+            releaseStart = 0.0f;
+            for (int stage = DELAY; stage < SUSTAIN; stage++) {
+                releaseStart += segments[stage].seconds;
+            }
 
-            maxLength = attack + sustain + release;
+            maxLength = releaseStart + segments[RELEASE].seconds;
             if (maxLength < 5.0f) maxLength = 5.0f;
         }
 
-        float getValueAtSeconds(float seconds) {
-            //
+        const EnvelopeSegment& getSegment(int stage) const {
+            return segments[stage];
         }
 
-        float getAttack(float seconds) {
-            float t = seconds / attack;
-            return juce::jmap<float>(t, 0.0f, 1.0f);
+        // The note is drawn as released the moment decay ends
+        float getValueAtSeconds(float seconds) const {
+            if (seconds <= 0.0f) return 0.0f;
+
+            float level = 0.0f;
+            float stageStart = 0.0f;
+
+            for (int stage = DELAY; stage < NUM_STAGES; stage++) {
+                const auto& segment = segments[stage];
+
+                if (seconds < stageStart + segment.seconds)
+                    return segment.getValueAt(level, (seconds - stageStart) / segment.seconds);
+
+                stageStart += segment.seconds;
+                level = segment.endLevel;
+            }
+
+            return 0.0f;
         }
 
-        float getDecay(float seconds) {
-            float t = (seconds - attack) / decay;
-            return juce::jmap<float>(t, 1.0f, sustain);
+        // x from 0 to 1 over getMaxLengthInSeconds()
+        float getValueAtNormalized(float x) const {
+            return getValueAtSeconds(x * maxLength);
         }
 
-        float getNormalizedRelease(float seconds) {
-            float t = (seconds - attack - decay) / release;
-            return juce::jmap<float>(t, 1.0f, 0.0f);
+    private:
+        static constexpr float ATTACK_RATIO = 0.3f;
+        static constexpr float DECAY_RATIO = 0.0001f;
+
+        // Zero length ramps still get a millisecond, otherwise they click
+        static constexpr float MIN_SEGMENT_SECONDS = 0.001f;
+
+        EnvelopeSegment segments[NUM_STAGES];
+        float releaseStart = 0.0f;
+        float maxLength = 5.0f;
+    };
+
+    /*
+     * Hands the envelope's shape from the audio thread to the editor.
+     *
+     * The audio thread publishes the knob values through a SeqLock, the editor
+     * rebuilds its own EnvelopeGraph from them and never reads the one the voices play.
+    */
+    class SharedEnvelopeShape {
+    public:
+        // Audio thread only
+        void publish(const EnvelopeGraph& graph) noexcept {
+            const float source[NUM_VALUES] = { graph.delay, graph.attack, graph.hold, graph.decay, graph.sustain, graph.release };
+
+            lock.write([&] {
+                for (int i = 0; i < NUM_VALUES; i++) {
+                    values[i].store(source[i], std::memory_order_relaxed);
+                }
+            });
         }
 
-        float getValueAtNormalized(float x) {
-            return 0.0f;
+        // Changes whenever a new shape is published
+        juce::uint32 getVersion() const noexcept {
+            return lock.getVersion();
         }
+
+        // Copies the latest shape into graph and returns its version
+        juce::uint32 read(EnvelopeGraph& graph) const noexcept {
+            float copy[NUM_VALUES];
+
+            const auto version = lock.read([&] {
+                for (int i = 0; i < NUM_VALUES; i++) {
+                    copy[i] = values[i].load(std::memory_order_relaxed);
+                }
+            });
+
+            graph.setParams(copy[0], copy[1], copy[2], copy[3], copy[4], copy[5]);
+            return version;
+        }
+
     private:
-        float maxLength;
+        static constexpr int NUM_VALUES = 6;
+
+        SeqLock lock;
+        std::atomic<float> values[NUM_VALUES] {};
     };
 
 
 
+    /*
+     * Per-sample envelope built from recursive exponential segments.
+     *
+     * Each stage of the EnvelopeGraph's segment table is rendered as
+     *     level = target + (level - target) * coefficient
+     * Coefficients are worked out once when a stage starts, the render loop is
+     * only multiplies and adds, and moving on is a step to the next table entry.
+    */
     class Envelope {
     public:
-        
         void setGraph(EnvelopeGraph* envelopeGraph) {
             env = envelopeGraph;
         }
 
-        void setSampleRate(int sampleRate) {
-            this->sampleRate = sampleRate;
-            this->sampleDuration = 1.0f / sampleRate;
-        }
+        void prepare(double newSampleRate) {
+            sampleRate = (float)newSampleRate;
 
-        void applyToBuffer(juce::AudioBuffer<float>& buffer, int startSample, int numSamples) {
+            // sustain knob moves are smoothed over ~5ms rather than jumping
+            sustainCoefficient = std::exp(-1.0f / (0.005f * sampleRate));
+        }
 
-            // sample rate = sampels per second
-            // so we need to convert our numSamples to duration in seconds
-            float duration = sampleDuration * numSamples;
+        // Writes the next numSamples envelope values into gainsOut
+        void getNextGains(float* gainsOut, int numSamples) {
+            int done = 0;
 
-            // so let's define the time range
-            currentTime += duration;
+            while (done < numSamples) {
+                if (!isActive()) {
+                    level = 0.0f;
+                    juce::FloatVectorOperations::clear(gainsOut + done, numSamples - done);
+                    return;
+                }
 
-            // and now we just need to grab the values
+                // the sustain level is read live, so it follows the knob
+                if (stage == EnvelopeGraph::SUSTAIN) {
+                    target = env->sustain;
+                    renderSegment(gainsOut + done, numSamples - done);
+                    return;
+                }
 
-            float targetGain = updateStateAndCalculateGain();
+                int length = juce::jmin(samplesLeft, numSamples - done);
+                renderSegment(gainsOut + done, length);
+                done += length;
+                samplesLeft -= length;
 
-            // Clear the buffer if it's appropiate (it's cheaper than ramping!)
-            if (lastGain == 0.0f && targetGain == 0.0f) {
-                buffer.clear();
-            } else {
-                buffer.applyGainRamp(startSample, numSamples, lastGain, targetGain);
+                if (samplesLeft == 0) {
+                    level = segmentEnd;
+                    if (length > 0) gainsOut[done - 1] = level;
+                    enterStage(stage + 1);
+                }
             }
-
-            lastGain = targetGain;
         }
 
-        float updateStateAndCalculateGain() {
-            // mute if inactive
-            if (state == INACTIVE)
-                return 0.0f;
+        float getCurrentGain() const {
+            return level;
+        }
 
-            // still sustaining
-            if (state == SUSTAINING)
-                return env->sustain;
+        bool isActive() const {
+            return stage != IDLE;
+        }
 
-            // releasing
-            if (state == RELEASING) {
-                if (currentTime > env->timeReleaseEnds) {
-                    state = INACTIVE;
-                    return 0.0f;
-                }
-                return releaseBeginGain * env->getNormalizedRelease(currentTime);
+        void noteOn() {
+            if (!env) {
+                stage = IDLE;
+                return;
             }
 
-            // Attacking?
-            if (currentTime < env->attack) {
-                state = ATTACKING;
-                return env->getAttack(currentTime);
-            }
+            // starts from wherever the level is, so retriggering does not click
+            enterStage(EnvelopeGraph::DELAY);
+        }
 
-            // Decaying?
-            if (currentTime < env->timeDecayEnds) {
-                state = DECAYING;
-                return env->getDecay(currentTime);
+        void noteOff() {
+            if (!env || !isActive()) {
+                stage = IDLE;
+                return;
             }
 
-            // if we reached so far, means we are sustaining
-            // currentTime is irrelevant at this point, we just return
-            // the sustain gain
-            state = SUSTAINING;
-            return env->sustain;
+            enterStage(EnvelopeGraph::RELEASE);
         }
 
-        bool isActive() {
-            bool isSilentRelease = (state == RELEASING && env->sustain == 0.0f);
-            bool isInactive = (state == INACTIVE);
-            return !isSilentRelease && !isInactive;
+        // Stops dead, without a release
+        void reset() {
+            stage = IDLE;
+            level = 0.0f;
         }
 
-        void noteOn() {
-            currentTime = 0;
-            state = ATTACKING;
+    private:
+        // one past the graph's stages, nothing left to play
+        static constexpr int IDLE = EnvelopeGraph::NUM_STAGES;
+
+        // Loads the table entry for newStage, stepping over zero length stages
+        void enterStage(int newStage) {
+            stage = newStage;
+
+            while (stage < EnvelopeGraph::NUM_STAGES) {
+                if (stage == EnvelopeGraph::SUSTAIN) {
+                    coefficient = sustainCoefficient;
+                    return;
+                }
+
+                const auto& segment = env->getSegment(stage);
+                samplesLeft = (int)std::round(segment.seconds * sampleRate);
+
+                if (samplesLeft > 0) {
+                    segmentEnd = segment.endLevel;
+                    coefficient = std::exp(-segment.steepness / (float)samplesLeft);
+                    target = segment.getTarget(level);
+                    return;
+                }
+
+                // done releasing, or a skipped stage after release
+                if (stage == EnvelopeGraph::RELEASE) break;
+                stage++;
+            }
+
+            stage = IDLE;
+            level = 0.0f;
         }
 
-        void noteOff() {
-            if (!env) {
-                state = INACTIVE;
-                return;
+        // level after k samples is target + (level - target) * coefficient^k,
+        // worked out four samples at a time so the loop vectorises
+        void renderSegment(float* out, int numSamples) {
+            const float c1 = coefficient;
+            const float c2 = c1 * c1;
+            const float c4 = c2 * c2;
+            const float distance = level - target;
+
+            float offset[4] = { distance * c1, distance * c2, distance * c2 * c1, distance * c4 };
+
+            int i = 0;
+            for (; i + 4 <= numSamples; i += 4) {
+                for (int lane = 0; lane < 4; lane++) {
+                    out[i + lane] = target + offset[lane];
+                    offset[lane] *= c4;
+                }
             }
-            currentTime = env->attack + env->decay; //fast forward to the release
-            releaseBeginGain = lastGain;
-            state = RELEASING;
+
+            float remaining = offset[0];
+            for (; i < numSamples; i++) {
+                out[i] = target + remaining;
+                remaining *= c1;
+            }
+
+            if (numSamples > 0) level = out[numSamples - 1];
         }
 
-    private:
-        EnvelopeGraph* env;
-        float currentTime = 0;
-        int sampleRate;
-        float lastGain = 0.0f;
-        float releaseBeginGain; // this is what we have to multiply with the release value
-        float sampleDuration;
-        enum EnvelopeState {
-            INACTIVE, ATTACKING, DECAYING, SUSTAINING, RELEASING
-        } state = INACTIVE;
-        
+        EnvelopeGraph* env = nullptr;
+        float sampleRate = 44100.0f;
+        float sustainCoefficient = 0.0f;
+
+        // current stage
+        int stage = IDLE;
+        float level = 0.0f;
+        float target = 0.0f;
+        float coefficient = 0.0f;
+        float segmentEnd = 0.0f;
+        int samplesLeft = 0;
     };
-}
\ No newline at end of file
+}
@@ -13,30 +13,23 @@
 #include "Envelope.h"
 
 namespace dubu {
-    class EnvelopeEditor : public juce::AnimatedAppComponent {
+    // Draws the envelope from the shape the audio thread last published
+    class EnvelopeEditor : public juce::Component {
     public:
-        void update() override
-        {
-
-        }
         void paint(juce::Graphics& g) override
         {
             auto w = getBounds().getWidth();
-            auto h = getBounds().getHeight();
-            auto maxSeconds = env->getMaxLengthInSeconds();
-            auto attack = (env->attack / maxSeconds) * w;
-            auto decay = (env->decay / maxSeconds) * w;
-            auto sustain = (1.0f - env->sustain) * h;
-            auto release = (env->release / maxSeconds) * w;
+            auto h = (float)getBounds().getHeight();
 
             g.setColour(juce::Colours::white);
 
-
+            // one point per pixel, from the same curves the voices play
             juce::Path p;
             p.startNewSubPath(0.0f, h);
-            p.lineTo(attack, 0.0f);
-            p.lineTo(attack + decay, sustain);
-            p.lineTo(attack + decay + release, h);
+            for (int x = 1; x <= w; x++) {
+                float value = graph.getValueAtNormalized((float)x / (float)w);
+                p.lineTo((float)x, (1.0f - value) * h);
+            }
 
             g.strokePath(p, juce::PathStrokeType(2.0f));
         }
@@ -46,13 +39,25 @@ namespace dubu {
             this->apvts = apvts;
         }
 
-        void attachEnvelopeGraph(dubu::EnvelopeGraph* envelopeGraph) {
-            env = envelopeGraph;
+        void attachEnvelopeShape(dubu::SharedEnvelopeShape* envelopeShape) {
+            shape = envelopeShape;
+        }
+
+        // Picks up a newly published shape, returns whether there was one
+        bool refresh() {
+            if (shape == nullptr || shape->getVersion() == shownVersion)
+                return false;
+
+            shownVersion = shape->read(graph);
+            return true;
         }
 
     private:
         juce::AudioProcessorValueTreeState* apvts;
-        dubu::EnvelopeGraph* env;
+        dubu::SharedEnvelopeShape* shape = nullptr;
 
+        // the editor's own copy, the audio thread never touches it
+        dubu::EnvelopeGraph graph;
+        juce::uint32 shownVersion = 0;
     };
-}
\ No newline at end of file
+}
@@ -0,0 +1,81 @@
+/*
+  ==============================================================================
+
+    HalfBandDecimator.h
+    Created: 17 Oct 2026 11:48:06pm
+    Author:  Norb
+
+  ==============================================================================
+*/
+
+#pragma once
+#include <JuceHeader.h>
+
+/*
+ * Halves the sample rate of one channel with a windowed-sinc half-band FIR.
+ *
+ * Every other tap of a half-band filter is zero apart from the centre one, so
+ * each output sample costs PAIRS multiply-adds over symmetric pairs plus the
+ * centre tap. Only every second output is ever computed (the polyphase form).
+ *
+ * The input lives inside the decimator, behind the filter's history: write up
+ * to MAX_INPUT samples to getInput(), then call process().
+*/
+template <int PAIRS, int MAX_INPUT>
+class HalfBandDecimator {
+public:
+    // filter length is 4 * PAIRS - 1, with the centre tap in the middle
+    static constexpr int HISTORY = 4 * PAIRS - 2;
+    static constexpr int LATENCY = 2 * PAIRS - 1; // in input samples
+
+    HalfBandDecimator() {
+        // Blackman windowed sinc at half the band. Odd distances from the centre
+        // are the only non-zero taps, normalised so the filter has unity gain.
+        float sum = 0.0f;
+        for (int k = 0; k < PAIRS; k++) {
+            const float distance = (float)(2 * k + 1);
+            const float x = juce::MathConstants<float>::halfPi * distance;
+            const float window = 0.42f + 0.5f * std::cos(juce::MathConstants<float>::pi * distance / (float)(2 * PAIRS))
+                               + 0.08f * std::cos(juce::MathConstants<float>::twoPi * distance / (float)(2 * PAIRS));
+
+            coefficients[k] = 0.5f * std::sin(x) / x * window;
+            sum += 2.0f * coefficients[k];
+        }
+
+        for (auto& c : coefficients) c *= 0.5f / sum;
+
+        reset();
+    }
+
+    void reset() noexcept {
+        std::fill(std::begin(buffer), std::end(buffer), 0.0f);
+    }
+
+    float* getInput() noexcept {
+        return buffer + HISTORY;
+    }
+
+    // Filters 2 * numOutput samples from getInput() down to numOutput samples in out
+    void process(float* out, int numOutput) noexcept {
+        jassert(2 * numOutput <= MAX_INPUT);
+
+        for (int i = 0; i < numOutput; i++) {
+            // centre of the filter for this output, the newest input being buffer[centre + LATENCY]
+            const float* centre = buffer + 2 * i + 1 + LATENCY;
+            float y = 0.5f * centre[0];
+
+            for (int k = 0; k < PAIRS; k++) {
+                y += coefficients[k] * (centre[2 * k + 1] + centre[-(2 * k + 1)]);
+            }
+
+            out[i] = y;
+        }
+
+        // the newest input becomes the next call's history
+        std::copy(buffer + 2 * numOutput, buffer + 2 * numOutput + HISTORY, buffer);
+    }
+
+private:
+    float coefficients[PAIRS];
+    float buffer[HISTORY + MAX_INPUT];
+};
@@ -0,0 +1,113 @@
+/*
+  ==============================================================================
+
+    ParameterCache.cpp
+    Created: 17 Oct 2026 5:03:18pm
+    Author:  Norb
+
+  ==============================================================================
+*/
+
+#include "ParameterCache.h"
+#include "Parameters.h"
+
+namespace {
+    bool operator!=(const UnisonBank::OscillatorParams& a, const UnisonBank::OscillatorParams& b)
+    {
+        return a.type != b.type || a.transpose != b.transpose || a.gain != b.gain
+            || a.phase != b.phase || a.stereo != b.stereo || a.invert != b.invert;
+    }
+}
+
+ParameterCache::ParameterCache(juce::AudioProcessorValueTreeState& apvts)
+{
+    auto resolve = [&apvts](const juce::String& id)
+        {
+            auto* value = apvts.getRawParameterValue(id);
+            jassert(value != nullptr); // parameter missing from createParams?
+            return value;
+        };
+
+    gain = resolve(Params::miscGain);
+    antiAlias = resolve(Params::miscAntiAlias);
+    polyphony = resolve(Params::miscPolyphony);
+    multiCore = resolve(Params::miscMultiCore);
+    oversampling = resolve(Params::miscOversampling);
+    offlineOversampling = resolve(Params::miscOversamplingOffline);
+    delay = resolve(Params::envDelay);
+    attack = resolve(Params::envAttack);
+    hold = resolve(Params::envHold);
+    decay = resolve(Params::envDecay);
+    sustain = resolve(Params::envSustain);
+    release = resolve(Params::envRelease);
+    unisonVoices = resolve(Params::unisonVoices);
+    unisonDetune = resolve(Params::unisonDetune);
+
+    for (int i = 0; i < UnisonBank::NUM_OSCILLATORS; i++) {
+        int id = i + 1;
+        osc[i] = OscillatorValues {
+            resolve(Params::oscShape(id)),
+            resolve(Params::oscTranspose(id)),
+            resolve(Params::oscMix(id)),
+            resolve(Params::oscPhase(id)),
+            resolve(Params::oscStereo(id)),
+            resolve(Params::oscInvert(id))
+        };
+    }
+
+    update();
+}
+
+const ParameterSnapshot& ParameterCache::update(bool nonRealtime) noexcept
+{
+    // start from the previous snapshot so the generations carry over
+    ParameterSnapshot next = snapshot;
+
+    // raw values are in the parameter's own range, e.g. transpose is -24 to 24
+    next.gain = gain->load();
+    next.polyphony = static_cast<int>(std::round(polyphony->load()));
+    next.multiCore = multiCore->load() > 0.5f;
+    next.nonRealtime = nonRealtime;
+    next.oversampling = 1 << static_cast<int>(std::round((nonRealtime ? offlineOversampling : oversampling)->load()));
+    next.delay = delay->load();
+    next.attack = attack->load();
+    next.hold = hold->load();
+    next.decay = decay->load();
+    next.sustain = sustain->load();
+    next.release = release->load();
+    next.unisonCount = static_cast<int>(std::round(unisonVoices->load())) + 1;
+    next.unisonDetune = unisonDetune->load();
+
+    for (int i = 0; i < UnisonBank::NUM_OSCILLATORS; i++) {
+        next.oscillators.osc[i] = UnisonBank::OscillatorParams {
+            (UnisonBank::WaveType)static_cast<int>(std::round(osc[i].shape->load())),
+            static_cast<int>(std::round(osc[i].transpose->load())),
+            osc[i].mix->load(),
+            osc[i].phase->load(),
+            osc[i].stereo->load(),
+            osc[i].invert->load() > 0.5f
+        };
+    }
+
+    next.oscillators.antiAliasing = nonRealtime || antiAlias->load() > 0.5f;
+
+    if (next.gain != snapshot.gain)
+        next.generation.gain++;
+
+    if (next.delay != snapshot.delay || next.attack != snapshot.attack || next.hold != snapshot.hold || next.decay != snapshot.decay
+        || next.sustain != snapshot.sustain || next.release != snapshot.release)
+        next.generation.envelope++;
+
+    if (next.unisonCount != snapshot.unisonCount || next.unisonDetune != snapshot.unisonDetune)
+        next.generation.unison++;
+
+    bool oscillatorsChanged = next.oscillators.antiAliasing != snapshot.oscillators.antiAliasing;
+    for (int i = 0; i < UnisonBank::NUM_OSCILLATORS; i++) {
+        oscillatorsChanged = oscillatorsChanged || next.oscillators.osc[i] != snapshot.oscillators.osc[i];
+    }
+    if (oscillatorsChanged)
+        next.generation.oscillators++;
+
+    snapshot = next;
+    return snapshot;
+}
@@ -0,0 +1,86 @@
+/*
+  ==============================================================================
+
+    ParameterCache.h
+    Created: 17 Oct 2026 5:03:18pm
+    Author:  Norb
+
+  ==============================================================================
+*/
+
+#pragma once
+#include <JuceHeader.h>
+#include "UnisonBank.h"
+
+// Plain copy of every parameter the audio thread needs for one block
+struct ParameterSnapshot {
+    float gain;
+    int polyphony;
+    bool multiCore;
+
+    // render quality, see ParameterCache::update
+    bool nonRealtime;
+    int oversampling; // 1, 2 or 4
+
+    // envelope
+    float delay, attack, hold, decay, sustain, release;
+
+    // unison
+    int unisonCount; // total layers, 1 to UnisonBank::MAX_UNISON
+    float unisonDetune;
+
+    UnisonBank::SyrberusOscillatorParams oscillators;
+
+    // Bumped whenever anything in the group changes, so whoever consumes the
+    // snapshot only has to re-derive the groups that actually moved
+    struct Generations {
+        juce::uint32 gain = 1, envelope = 1, unison = 1, oscillators = 1;
+    } generation;
+};
+
+/*
+ * Resolves the raw parameter values once, so that taking a snapshot on the
+ * audio thread is a handful of atomic loads: no string building, no lookups
+ * and no allocations.
+*/
+class ParameterCache {
+public:
+    explicit ParameterCache(juce::AudioProcessorValueTreeState& apvts);
+
+    // Reads the current parameter values and bumps the generation of every
+    // group that changed since the last call, call once per block.
+    //
+    // A non-realtime render (a bounce) gets the offline profile: the offline
+    // oversampling setting and band-limited oscillators whatever the Anti-alias
+    // switch says. Playback keeps the cheaper settings the user picked.
+    const ParameterSnapshot& update(bool nonRealtime = false) noexcept;
+    const ParameterSnapshot& getSnapshot() const noexcept { return snapshot; }
+
+private:
+    struct OscillatorValues {
+        std::atomic<float>* shape;
+        std::atomic<float>* transpose;
+        std::atomic<float>* mix;
+        std::atomic<float>* phase;
+        std::atomic<float>* stereo;
+        std::atomic<float>* invert;
+    };
+
+    std::atomic<float>* gain;
+    std::atomic<float>* antiAlias;
+    std::atomic<float>* polyphony;
+    std::atomic<float>* multiCore;
+    std::atomic<float>* oversampling;
+    std::atomic<float>* offlineOversampling;
+    std::atomic<float>* delay;
+    std::atomic<float>* attack;
+    std::atomic<float>* hold;
+    std::atomic<float>* decay;
+    std::atomic<float>* sustain;
+    std::atomic<float>* release;
+    std::atomic<float>* unisonVoices;
+    std::atomic<float>* unisonDetune;
+    OscillatorValues osc[UnisonBank::NUM_OSCILLATORS];
+
+    ParameterSnapshot snapshot {};
+};
@@ -12,6 +12,7 @@
 
 namespace Params {
     // Envelope
+    inline constexpr auto envDelay = "ENV_DELAY";
     inline constexpr auto envAttack = "ENV_ATTACK";
     inline constexpr auto envHold = "ENV_HOLD";
     inline constexpr auto envDecay = "ENV_DECAY";
@@ -24,6 +25,11 @@ namespace Params {
 
     // Misc
     inline constexpr auto miscGain = "MISC_GAIN";
+    inline constexpr auto miscAntiAlias = "MISC_ANTIALIAS";
+    inline constexpr auto miscPolyphony = "MISC_POLYPHONY";
+    inline constexpr auto miscMultiCore = "MISC_MULTICORE";
+    inline constexpr auto miscOversampling = "MISC_OVERSAMPLING";
+    inline constexpr auto miscOversamplingOffline = "MISC_OVERSAMPLING_OFFLINE";
 
     // Osc 1
     inline constexpr auto osc1Shape = "OSC1_SHAPE";
@@ -0,0 +1,62 @@
+/*
+  ==============================================================================
+
+    PerformanceCounters.cpp
+    Created: 17 Oct 2026 10:48:13pm
+    Author:  Norb
+
+  ==============================================================================
+*/
+
+#include "PerformanceCounters.h"
+
+void PerformanceCounters::recordBlock(juce::int64 renderTicks, int numSamples, double sampleRate,
+                                      int activeVoices, int polyphony, int activeLayers) noexcept
+{
+    if (numSamples <= 0 || sampleRate <= 0.0) return;
+
+    const double renderSeconds = juce::Time::highResolutionTicksToSeconds(renderTicks);
+    const double deadline = numSamples / sampleRate;
+    const float load = (float)(renderSeconds / deadline);
+
+    // one-pole average over ~0.5s, whatever the block size
+    const float smoothing = 1.0f - (float)std::exp(-deadline / 0.5);
+    averageLoad += (load - averageLoad) * smoothing;
+
+    if (peakResetRequested.exchange(false, std::memory_order_relaxed))
+        peakLoad = 0.0f;
+
+    peakLoad = juce::jmax(peakLoad, load);
+
+    if (load > XRUN_RISK_LOAD)
+        xrunRisks++;
+
+    const float renderMicros = (float)(renderSeconds * 1.0e6);
+
+    lock.write([&] {
+        publishedRenderMicros.store(renderMicros, std::memory_order_relaxed);
+        publishedLoad.store(averageLoad, std::memory_order_relaxed);
+        publishedPeakLoad.store(peakLoad, std::memory_order_relaxed);
+        publishedXrunRisks.store(xrunRisks, std::memory_order_relaxed);
+        publishedActiveVoices.store(activeVoices, std::memory_order_relaxed);
+        publishedPolyphony.store(polyphony, std::memory_order_relaxed);
+        publishedActiveLayers.store(activeLayers, std::memory_order_relaxed);
+    });
+}
+
+PerformanceSnapshot PerformanceCounters::read() const noexcept
+{
+    PerformanceSnapshot snapshot;
+
+    lock.read([&] {
+        snapshot.renderMicros = publishedRenderMicros.load(std::memory_order_relaxed);
+        snapshot.load = publishedLoad.load(std::memory_order_relaxed);
+        snapshot.peakLoad = publishedPeakLoad.load(std::memory_order_relaxed);
+        snapshot.xrunRisks = publishedXrunRisks.load(std::memory_order_relaxed);
+        snapshot.activeVoices = publishedActiveVoices.load(std::memory_order_relaxed);
+        snapshot.polyphony = publishedPolyphony.load(std::memory_order_relaxed);
+        snapshot.activeLayers = publishedActiveLayers.load(std::memory_order_relaxed);
+    });
+
+    return snapshot;
+}
@@ -0,0 +1,62 @@
+/*
+  ==============================================================================
+
+    PerformanceCounters.h
+    Created: 17 Oct 2026 10:48:13pm
+    Author:  Norb
+
+  ==============================================================================
+*/
+
+#pragma once
+#include <JuceHeader.h>
+#include "SeqLock.h"
+
+// What the audio thread measured, as last published
+struct PerformanceSnapshot {
+    float renderMicros = 0.0f;  // time spent in the last processBlock
+    float load = 0.0f;          // render time over the block's deadline, averaged over ~half a second
+    float peakLoad = 0.0f;      // highest single block since the last resetPeak()
+    juce::uint32 xrunRisks = 0; // blocks that used more than XRUN_RISK_LOAD of their deadline
+    int activeVoices = 0;
+    int polyphony = 0;
+    int activeLayers = 0;       // unison layers actually rendered, across the active voices
+};
+
+/*
+ * Audio thread instrumentation the editor can read at any time.
+ *
+ * The audio thread is the only writer and publishes every block through a
+ * SeqLock. Neither side ever blocks, and the reader never touches the synth or
+ * its voices.
+*/
+class PerformanceCounters {
+public:
+    // A block using more than this much of its deadline leaves the host little room
+    static constexpr float XRUN_RISK_LOAD = 0.7f;
+
+    // Audio thread only, once per block
+    void recordBlock(juce::int64 renderTicks, int numSamples, double sampleRate,
+                     int activeVoices, int polyphony, int activeLayers) noexcept;
+
+    // Any thread
+    PerformanceSnapshot read() const noexcept;
+    void resetPeak() noexcept { peakResetRequested.store(true, std::memory_order_relaxed); }
+
+private:
+    // writer side state, only touched by the audio thread
+    float averageLoad = 0.0f;
+    float peakLoad = 0.0f;
+    juce::uint32 xrunRisks = 0;
+
+    SeqLock lock;
+    std::atomic<float> publishedRenderMicros { 0.0f };
+    std::atomic<float> publishedLoad { 0.0f };
+    std::atomic<float> publishedPeakLoad { 0.0f };
+    std::atomic<juce::uint32> publishedXrunRisks { 0 };
+    std::atomic<int> publishedActiveVoices { 0 };
+    std::atomic<int> publishedPolyphony { 0 };
+    std::atomic<int> publishedActiveLayers { 0 };
+
+    std::atomic<bool> peakResetRequested { false };
+};
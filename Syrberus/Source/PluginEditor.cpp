@@ -45,6 +45,7 @@ void SyrberusAudioProcessorEditor::initOsc(OscilatorGroup& osc, int oscId, Radio
     initShapeButton(osc.triangle, shapeParamId, group, 2);
     initShapeButton(osc.saw, shapeParamId, group, 3);
     initShapeButton(osc.sineSquare, shapeParamId, group, 4);
+    osc.shapeGroup.attach(audioProcessor.apvts, shapeParamId, { &osc.sine, &osc.square, &osc.triangle, &osc.saw, &osc.sineSquare });
 
     osc.invert.setButtonText("Invert");
     osc.invert.setLookAndFeel(&sliderLaf);
@@ -60,6 +61,7 @@ SyrberusAudioProcessorEditor::SyrberusAudioProcessorEditor (SyrberusAudioProcess
 {
     addAndMakeVisible(keyboardComponent);
 
+    initKnob(envDelay, Params::envDelay, "Delay", envDelayAttachment);
     initKnob(envAttack, Params::envAttack, "Attack", envAttackAttachment);
     initKnob(envHold, Params::envHold, "Hold", envHoldAttachment);
     initKnob(envDecay, Params::envDecay, "Decay", envDecayAttachment);
@@ -78,21 +80,23 @@ SyrberusAudioProcessorEditor::SyrberusAudioProcessorEditor (SyrberusAudioProcess
     initOsc(osc3, 3, RadioGroups::Oscilator3);
 
     wavePreview.attachApvts(&audioProcessor.apvts);
-    wavePreview.setFramesPerSecond(60);
+    wavePreview.attachScope(&p.scope);
     wavePreview.setOpaque(false);
     addAndMakeVisible(wavePreview);
 
-    debugInfo.init(&p.synth);
-    debugInfo.setFramesPerSecond(60);
+    debugInfo.init(&p.performance);
     debugInfo.setOpaque(false);
     addAndMakeVisible(debugInfo);
 
     envelopeEditor.attachApvts(&audioProcessor.apvts);
-    envelopeEditor.attachEnvelopeGraph(&p.envelopeGraph);
-    envelopeEditor.setFramesPerSecond(60);
+    envelopeEditor.attachEnvelopeShape(&p.envelopeShape);
     envelopeEditor.setOpaque(false);
     addAndMakeVisible(envelopeEditor);
 
+    // both only repaint when what they show has moved, the numbers at a readable rate
+    repaintScheduler.add(envelopeEditor, 60, [this] { return envelopeEditor.refresh(); });
+    repaintScheduler.add(debugInfo, 10, [this] { return debugInfo.refresh(); });
+
     // load images
     imgLogo = juce::ImageFileFormat::loadFrom(BinaryData::logo_png, BinaryData::logo_pngSize);
 
@@ -219,16 +223,17 @@ void SyrberusAudioProcessorEditor::positionOsc(OscilatorGroup& osc, int offsetY)
 
 void SyrberusAudioProcessorEditor::positionEnvelope()
 {
-    float knobSize = 64;
-    float gap = knobSize + 4;
+    float knobSize = 56;
+    float gap = knobSize + 2;
     float knobHeight = knobSize + 16;
-    float oscKnobStartX = 550;
-    float oscKnobStartY = 148;
-    envAttack.setBounds(oscKnobStartX + gap * 0, oscKnobStartY, knobSize, knobHeight);
-    //envHold.setBounds(oscKnobStartX + gap * 1, oscKnobStartY, knobSize, knobHeight);
-    envDecay.setBounds(oscKnobStartX + gap * 2, oscKnobStartY, knobSize, knobHeight);
-    envSustain.setBounds(oscKnobStartX + gap * 3, oscKnobStartY, knobSize, knobHeight);
-    envRelease.setBounds(oscKnobStartX + gap * 4, oscKnobStartY, knobSize, knobHeight);
+    float oscKnobStartX = 546;
+    float oscKnobStartY = 152;
+    envDelay.setBounds(oscKnobStartX + gap * 0, oscKnobStartY, knobSize, knobHeight);
+    envAttack.setBounds(oscKnobStartX + gap * 1, oscKnobStartY, knobSize, knobHeight);
+    envHold.setBounds(oscKnobStartX + gap * 2, oscKnobStartY, knobSize, knobHeight);
+    envDecay.setBounds(oscKnobStartX + gap * 3, oscKnobStartY, knobSize, knobHeight);
+    envSustain.setBounds(oscKnobStartX + gap * 4, oscKnobStartY, knobSize, knobHeight);
+    envRelease.setBounds(oscKnobStartX + gap * 5, oscKnobStartY, knobSize, knobHeight);
 }
 
 void SyrberusAudioProcessorEditor::resized()
@@ -250,6 +255,6 @@ void SyrberusAudioProcessorEditor::resized()
     positionOsc(osc3, 240);
 
     wavePreview.setBounds(15, 395, 500, 130);
-    debugInfo.setBounds(528, 395 + 90, 100, 100);
+    debugInfo.setBounds(528, 395 + 90, 200, 100);
     envelopeEditor.setBounds(548, 38, 340, 100);
 }
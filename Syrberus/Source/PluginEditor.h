@@ -13,6 +13,7 @@
 #include "MainLookAndFeel.h"
 #include "ShapeSelectButton.h"
 #include "WavePreview.h"
+#include "RepaintScheduler.h"
 #include "DebugInfo.h"
 #include "EnvelopeEditor.h"
 
@@ -27,6 +28,7 @@ public:
 
     struct OscilatorGroup {
         ShapeSelectButton sine, square, triangle, saw, sineSquare;
+        ShapeSelectGroup shapeGroup;
         juce::Slider phase;
         juce::ToggleButton invert;
         juce::Slider transpose;
@@ -65,10 +67,12 @@ private:
     dubu::EnvelopeEditor envelopeEditor;
     WavePreview wavePreview;
     DebugInfo debugInfo;
+    RepaintScheduler repaintScheduler;
 
     MainLookAndFeel sliderLaf;
 
     juce::MidiKeyboardComponent keyboardComponent;
+    juce::Slider envDelay;
     juce::Slider envAttack;
     juce::Slider envHold;
     juce::Slider envDecay;
@@ -81,6 +85,7 @@ private:
 
     juce::Image imgLogo;
 
+    std::unique_ptr<juce::AudioProcessorValueTreeState::SliderAttachment> envDelayAttachment;
     std::unique_ptr<juce::AudioProcessorValueTreeState::SliderAttachment> envAttackAttachment;
     std::unique_ptr<juce::AudioProcessorValueTreeState::SliderAttachment> envHoldAttachment;
     std::unique_ptr<juce::AudioProcessorValueTreeState::SliderAttachment> envDecayAttachment;
@@ -10,6 +10,17 @@
 #include "PluginEditor.h"
 #include "Parameters.h"
 
+namespace {
+    // Version of the parameter tree, stored on it. Trees without one come from before
+    // Hold worked, or were written by hand.
+    const juce::Identifier stateVersionId("stateVersion");
+    constexpr int STATE_VERSION = 1;
+
+    // Hold's default before it worked. It could not be edited then, so any other value
+    // in an unversioned tree was set on purpose, by hand.
+    constexpr float LEGACY_HOLD = 0.5f;
+}
+
 //==============================================================================
 SyrberusAudioProcessor::SyrberusAudioProcessor()
 #ifndef JucePlugin_PreferredChannelConfigurations
@@ -20,18 +31,19 @@ SyrberusAudioProcessor::SyrberusAudioProcessor()
                       #endif
                        .withOutput ("Output", juce::AudioChannelSet::stereo(), true)
                      #endif
-                       ), apvts(*this, nullptr, "Parameters", createParams())
+                       ), apvts(*this, nullptr, "Parameters", createParams()),
+                       parameters(apvts), presetFormat(apvts)
 #endif
 {
-    synth.addSound(new SyrberusSound());
-
-    for (int i = 0; i < 8; i++) {
-        synth.addVoice(new SyrberusVoice());
-    }
+    apvts.state.setProperty(stateVersionId, STATE_VERSION, nullptr);
+    openPresetLibrary(PresetLibrary::getDefaultFile());
+    apvts.addParameterListener(Params::miscMultiCore, this);
 }
 
 SyrberusAudioProcessor::~SyrberusAudioProcessor()
 {
+    apvts.removeParameterListener(Params::miscMultiCore, this);
+    cancelPendingUpdate();
 }
 
 //==============================================================================
@@ -74,22 +86,27 @@ double SyrberusAudioProcessor::getTailLengthSeconds() const
 
 int SyrberusAudioProcessor::getNumPrograms()
 {
-    return 1;   // NB: some hosts don't cope very well if you tell them there are 0 programs,
-                // so this should be at least 1, even if you're not really implementing programs.
+    return juce::jmax(1, presets.getNumPresets());   // NB: some hosts don't cope very well if you tell them there are 0 programs,
+                                                      // so this should be at least 1, even without a library.
 }
 
 int SyrberusAudioProcessor::getCurrentProgram()
 {
-    return 0;
+    return currentProgram;
 }
 
 void SyrberusAudioProcessor::setCurrentProgram (int index)
 {
+    const void* data;
+    size_t size;
+
+    if (presets.getState(index, data, size) && presetFormat.read(data, size))
+        currentProgram = index;
 }
 
 const juce::String SyrberusAudioProcessor::getProgramName (int index)
 {
-    return {};
+    return presets.getName(index);
 }
 
 void SyrberusAudioProcessor::changeProgramName (int index, const juce::String& newName)
@@ -101,16 +118,10 @@ void SyrberusAudioProcessor::prepareToPlay (double sampleRate, int samplesPerBlo
 {
     // Use this method as the place to do any pre-playback
     // initialisation that you need..
-    synth.setCurrentPlaybackSampleRate(sampleRate);
+    scope.setSampleRate(sampleRate);
+    synth.prepare(sampleRate, samplesPerBlock, getTotalNumOutputChannels());
     keyboardState.reset();
 
-    for (int i = 0; i < synth.getNumVoices(); i++) {
-        if (auto voice = dynamic_cast<SyrberusVoice*>(synth.getVoice(i)))
-        {
-            voice->prepareToPlay(sampleRate, samplesPerBlock, getTotalNumOutputChannels());
-        }
-    }
-
     juce::dsp::ProcessSpec spec;
     spec.sampleRate = sampleRate;
     spec.maximumBlockSize = samplesPerBlock;
@@ -119,12 +130,44 @@ void SyrberusAudioProcessor::prepareToPlay (double sampleRate, int samplesPerBlo
     limiter.prepare(spec);
     limiter.setThreshold(3.0f); // Example threshold in dB
     limiter.setRelease(10.0f);   // Release time in milliseconds
+
+    prepared = true;
+    updateRenderPool();
 }
 
 void SyrberusAudioProcessor::releaseResources()
 {
     // When playback stops, you can use this as an opportunity to free up any
     // spare memory, etc.
+    prepared = false;
+    updateRenderPool();
+}
+
+void SyrberusAudioProcessor::parameterChanged(const juce::String&, float)
+{
+    triggerAsyncUpdate();
+}
+
+void SyrberusAudioProcessor::handleAsyncUpdate()
+{
+    updateRenderPool();
+}
+
+void SyrberusAudioProcessor::updateRenderPool()
+{
+    const bool wanted = prepared && apvts.getRawParameterValue(Params::miscMultiCore)->load() > 0.5f;
+    if (wanted == synth.hasRenderPool()) return;
+
+    // the threads are started before and joined after the lock, the audio thread
+    // only ever waits for the pointer swap
+    auto pool = wanted ? SyrberusSynthesiser::createRenderPool() : nullptr;
+
+    {
+        const juce::ScopedLock lock(getCallbackLock());
+        pool = synth.swapRenderPool(std::move(pool));
+    }
+
+    pool.reset();
 }
 
 #ifndef JucePlugin_PreferredChannelConfigurations
@@ -156,6 +199,7 @@ bool SyrberusAudioProcessor::isBusesLayoutSupported (const BusesLayout& layouts)
 void SyrberusAudioProcessor::processBlock (juce::AudioBuffer<float>& buffer, juce::MidiBuffer& midiMessages)
 {
     juce::ScopedNoDenormals noDenormals;
+    const auto blockStart = juce::Time::getHighResolutionTicks();
     auto totalNumInputChannels  = getTotalNumInputChannels();
     auto totalNumOutputChannels = getTotalNumOutputChannels();
     auto numSamples = buffer.getNumSamples();
@@ -169,34 +213,32 @@ void SyrberusAudioProcessor::processBlock (juce::AudioBuffer<float>& buffer, juc
     for (auto i = totalNumInputChannels; i < totalNumOutputChannels; ++i)
         buffer.clear (i, 0, numSamples);
 
-    float gain = apvts.getRawParameterValue(Params::miscGain)->load();
-    float attack = apvts.getRawParameterValue(Params::envAttack)->load();
-    float decay = apvts.getRawParameterValue(Params::envDecay)->load();
-    float sustain = apvts.getRawParameterValue(Params::envSustain)->load();
-    float release = apvts.getRawParameterValue(Params::envRelease)->load();
+    const auto& params = parameters.update(isNonRealtime());
 
-    int unisonVoices = apvts.getParameter(Params::unisonVoices)->getValue() * 16;
-    float unisonDetune = apvts.getRawParameterValue(Params::unisonDetune)->load();
-
-
-    UnisonVoice::SyrberusOscillatorParams syrOscParams(apvts);
+    if (params.generation.envelope != envelopeGeneration) {
+        envelopeGraph.setParams(params.delay, params.attack, params.hold, params.decay, params.sustain, params.release);
+        envelopeShape.publish(envelopeGraph);
+        envelopeGeneration = params.generation.envelope;
+    }
 
-    envelopeGraph.setParams(attack, decay, sustain, release);
+    synth.setPolyphony(params.polyphony);
+    synth.setParallelRendering(params.multiCore);
+    synth.setOversampling(params.oversampling);
 
-    for (int i = 0; i < synth.getNumVoices(); i++) {
-        if (auto voice = dynamic_cast<SyrberusVoice*>(synth.getVoice(i)))
-        {
-            voice->updateParams(gain, &envelopeGraph);
-            voice->updateParams(syrOscParams);
-            voice->setUnison(unisonVoices + 1, unisonDetune);
-        }
-    }
+    synth.applySnapshot(params, &envelopeGraph);
 
     keyboardState.processNextMidiBuffer(midiMessages, 0, numSamples, true);
     synth.renderNextBlock(buffer, midiMessages, 0, numSamples);
 
     juce::dsp::AudioBlock<float> audioBlock(buffer);
     limiter.process(juce::dsp::ProcessContextReplacing<float>(audioBlock));
+
+    scope.push(buffer.getReadPointer(0), totalNumOutputChannels > 1 ? buffer.getReadPointer(1) : nullptr, numSamples);
+
+    int activeVoices, activeLayers;
+    synth.countActive(activeVoices, activeLayers);
+    performance.recordBlock(juce::Time::getHighResolutionTicks() - blockStart, numSamples, getSampleRate(),
+                            activeVoices, synth.getPolyphony(), activeLayers);
 }
 
 //==============================================================================
@@ -213,22 +255,51 @@ juce::AudioProcessorEditor* SyrberusAudioProcessor::createEditor()
 //==============================================================================
 void SyrberusAudioProcessor::getStateInformation (juce::MemoryBlock& destData)
 {
-    // You should use this method to store your parameters in the memory block.
-    // You could do that either as raw data, or use the XML or ValueTree classes
-    // as intermediaries to make it easy to save and load complex data.
-    auto state = apvts.copyState();
-    std::unique_ptr<juce::XmlElement> xml(state.createXml());
-    copyXmlToBinary(*xml, destData);
+    presetFormat.write(destData);
 }
 
 void SyrberusAudioProcessor::setStateInformation (const void* data, int sizeInBytes)
 {
-    // You should use this method to restore your parameters from this memory block,
-    // whose contents will have been created by the getStateInformation() call.
+    if (PresetFormat::isBinaryState(data, (size_t)sizeInBytes)) {
+        presetFormat.read(data, (size_t)sizeInBytes);
+        return;
+    }
+
+    // sessions and presets saved before the binary format are the parameter tree as XML
     std::unique_ptr<juce::XmlElement> xmlState(getXmlFromBinary(data, sizeInBytes));
     if (xmlState.get() != nullptr)
-        if (xmlState->hasTagName(apvts.state.getType()))
-            apvts.replaceState(juce::ValueTree::fromXml(*xmlState));
+        if (xmlState->hasTagName(apvts.state.getType())) {
+            auto state = juce::ValueTree::fromXml(*xmlState);
+            migrateState(state);
+            apvts.replaceState(state);
+        }
+}
+
+void SyrberusAudioProcessor::migrateState(juce::ValueTree& state)
+{
+    if ((int)state.getProperty(stateVersionId, 0) < 1) {
+        // Hold used to be ignored, keep those patches sounding the way they were saved
+        auto hold = state.getChildWithProperty("id", Params::envHold);
+        if (hold.isValid() && (float)hold.getProperty("value") == LEGACY_HOLD)
+            hold.setProperty("value", 0.0f, nullptr);
+    }
+
+    state.setProperty(stateVersionId, STATE_VERSION, nullptr);
+}
+
+bool SyrberusAudioProcessor::openPresetLibrary (const juce::File& file)
+{
+    currentProgram = 0;
+    return presets.open(file);
+}
+
+bool SyrberusAudioProcessor::loadPreset (const juce::String& name)
+{
+    const int index = presets.indexOf(name);
+    if (index < 0) return false;
+
+    setCurrentProgram(index);
+    return currentProgram == index;
 }
 
 //==============================================================================
@@ -243,8 +314,9 @@ juce::AudioProcessorValueTreeState::ParameterLayout SyrberusAudioProcessor::crea
     std::vector<std::unique_ptr<juce::RangedAudioParameter>> params;
 
     // Envelope
+    params.push_back(std::make_unique<juce::AudioParameterFloat>(Params::envDelay, "Delay", 0.0f, 5.0f, 0.0f));
     params.push_back(std::make_unique<juce::AudioParameterFloat>(Params::envAttack, "Attack", 0.0f, 5.0f, 0.2f));
-    params.push_back(std::make_unique<juce::AudioParameterFloat>(Params::envHold, "Hold", 0.0f, 1.0f, 0.5f));
+    params.push_back(std::make_unique<juce::AudioParameterFloat>(Params::envHold, "Hold", 0.0f, 1.0f, 0.0f));
     params.push_back(std::make_unique<juce::AudioParameterFloat>(Params::envDecay, "Decay", 0.0f, 5.0f, 0.5f));
     params.push_back(std::make_unique<juce::AudioParameterFloat>(Params::envSustain, "Sustain", 0.0f, 1.0f, 1.0f));
     params.push_back(std::make_unique<juce::AudioParameterFloat>(Params::envRelease, "Release", 0.0f, 5.0f, 0.5f));
@@ -255,6 +327,11 @@ juce::AudioProcessorValueTreeState::ParameterLayout SyrberusAudioProcessor::crea
 
     // Misc
     params.push_back(std::make_unique<juce::AudioParameterFloat>(Params::miscGain, "Gain", 0.0f, 1.0f, 0.5f));
+    params.push_back(std::make_unique<juce::AudioParameterBool>(Params::miscAntiAlias, "Anti-alias", true));
+    params.push_back(std::make_unique<juce::AudioParameterInt>(Params::miscPolyphony, "Polyphony", 1, SyrberusSynthesiser::MAX_POLYPHONY, 8));
+    params.push_back(std::make_unique<juce::AudioParameterBool>(Params::miscMultiCore, "Multi-core", false));
+    params.push_back(std::make_unique<juce::AudioParameterChoice>(Params::miscOversampling, "Oversampling", juce::StringArray { "Off", "2x", "4x" }, 0));
+    params.push_back(std::make_unique<juce::AudioParameterChoice>(Params::miscOversamplingOffline, "Oversampling (Offline)", juce::StringArray { "Off", "2x", "4x" }, 2));
 
     // Osc 1
     params.push_back(std::make_unique<juce::AudioParameterInt>(Params::osc1Shape, "Wave Shape (Osc1)", 0, 4, 0));
@@ -10,11 +10,18 @@
 
 #include <JuceHeader.h>
 #include "SyrberusSynth.h"
+#include "ParameterCache.h"
+#include "PerformanceCounters.h"
+#include "ScopeBuffer.h"
+#include "PresetFormat.h"
+#include "PresetLibrary.h"
 
 //==============================================================================
 /**
 */
-class SyrberusAudioProcessor  : public juce::AudioProcessor
+class SyrberusAudioProcessor  : public juce::AudioProcessor,
+                                private juce::AudioProcessorValueTreeState::Listener,
+                                private juce::AsyncUpdater
 {
 public:
     //==============================================================================
@@ -54,17 +61,42 @@ public:
     void getStateInformation (juce::MemoryBlock& destData) override;
     void setStateInformation (const void* data, int sizeInBytes) override;
 
+    //==============================================================================
+    // The presets shown as the host's programs, by default the user's Presets.syrlib
+    bool openPresetLibrary (const juce::File& file);
+    bool loadPreset (const juce::String& name);
+    const PresetLibrary& getPresetLibrary() const noexcept { return presets; }
+
     //==============================================================================
     // These have to be public for the Editor to access it
     juce::MidiKeyboardState keyboardState;
     juce::AudioProcessorValueTreeState apvts;
-    juce::Synthesiser synth;
+    SyrberusSynthesiser synth;
     dubu::EnvelopeGraph envelopeGraph;
+    dubu::SharedEnvelopeShape envelopeShape;    // envelopeGraph, for the editor
+    PerformanceCounters performance;
+    ScopeBuffer scope;
 
 private:
     //==============================================================================
-    juce::AudioProcessorValueTreeState::ParameterLayout SyrberusAudioProcessor::createParams();
+    juce::AudioProcessorValueTreeState::ParameterLayout createParams();
+
+    // Brings a parameter tree saved by an older version up to date
+    static void migrateState(juce::ValueTree& state);
+
+    // The render pool's threads only exist while prepared and MISC_MULTICORE is on.
+    // Changes arrive on any thread and are applied on the message thread.
+    void parameterChanged(const juce::String& parameterID, float newValue) override;
+    void handleAsyncUpdate() override;
+    void updateRenderPool();
+    std::atomic<bool> prepared { false };
+
     juce::dsp::Limiter<float> limiter;
+    ParameterCache parameters;
+    PresetFormat presetFormat;
+    PresetLibrary presets;
+    int currentProgram = 0;
+    juce::uint32 envelopeGeneration = 0;
 
     JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (SyrberusAudioProcessor)
 };
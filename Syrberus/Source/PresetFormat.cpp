@@ -0,0 +1,81 @@
+/*
+  ==============================================================================
+
+    PresetFormat.cpp
+    Created: 18 Oct 2026 2:05:31am
+    Author:  Norb
+
+  ==============================================================================
+*/
+
+#include "PresetFormat.h"
+#include "Parameters.h"
+
+namespace {
+    const juce::uint32 MAGIC = juce::ByteOrder::littleEndianInt("SYRB");
+    constexpr size_t HEADER_SIZE = 8;
+
+    // NEVER reorder or remove, only append (and bump PresetFormat::VERSION)
+    const char* const PARAMETER_ORDER[] = {
+        Params::envDelay, Params::envAttack, Params::envHold, Params::envDecay, Params::envSustain, Params::envRelease,
+        Params::unisonVoices, Params::unisonDetune,
+        Params::miscGain, Params::miscAntiAlias, Params::miscPolyphony, Params::miscMultiCore,
+        Params::miscOversampling, Params::miscOversamplingOffline,
+        Params::osc1Shape, Params::osc1Phase, Params::osc1Invert, Params::osc1Transpose, Params::osc1Stereo, Params::osc1Mix,
+        Params::osc2Shape, Params::osc2Phase, Params::osc2Invert, Params::osc2Transpose, Params::osc2Stereo, Params::osc2Mix,
+        Params::osc3Shape, Params::osc3Phase, Params::osc3Invert, Params::osc3Transpose, Params::osc3Stereo, Params::osc3Mix
+    };
+}
+
+PresetFormat::PresetFormat(juce::AudioProcessorValueTreeState& apvts)
+{
+    for (auto* id : PARAMETER_ORDER) {
+        auto* parameter = apvts.getParameter(id);
+        jassert(parameter != nullptr); // parameter missing from createParams?
+        parameters.push_back(parameter);
+    }
+}
+
+bool PresetFormat::isBinaryState(const void* data, size_t sizeInBytes) noexcept
+{
+    return data != nullptr && sizeInBytes >= HEADER_SIZE
+        && juce::ByteOrder::littleEndianInt(data) == MAGIC;
+}
+
+void PresetFormat::write(juce::MemoryBlock& destData) const
+{
+    destData.reset();
+    juce::MemoryOutputStream stream(destData, false);
+
+    stream.writeInt((int)MAGIC);
+    stream.writeShort((short)VERSION);
+    stream.writeShort((short)parameters.size());
+
+    for (auto* parameter : parameters) {
+        stream.writeFloat(parameter->convertFrom0to1(parameter->getValue()));
+    }
+}
+
+bool PresetFormat::read(const void* data, size_t sizeInBytes) const
+{
+    if (!isBinaryState(data, sizeInBytes))
+        return false;
+
+    juce::MemoryInputStream stream(data, sizeInBytes, false);
+    stream.skipNextBytes(6);
+
+    const size_t stored = (size_t)(juce::uint16)stream.readShort();
+    const size_t available = juce::jmin(stored, (sizeInBytes - HEADER_SIZE) / sizeof(float));
+
+    for (size_t i = 0; i < parameters.size(); i++) {
+        auto* parameter = parameters[i];
+        const float normalised = i < available ? parameter->convertTo0to1(stream.readFloat())
+                                               : parameter->getDefaultValue();
+
+        // only the ones that actually change reach the host and the listeners
+        if (parameter->getValue() != normalised)
+            parameter->setValueNotifyingHost(normalised);
+    }
+
+    return true;
+}
@@ -0,0 +1,45 @@
+/*
+  ==============================================================================
+
+    PresetFormat.h
+    Created: 18 Oct 2026 2:05:31am
+    Author:  Norb
+
+  ==============================================================================
+*/
+
+#pragma once
+#include <JuceHeader.h>
+
+/*
+ * The plugin's state as a flat binary record:
+ *
+ *     uint32  magic, "SYRB"
+ *     uint16  version
+ *     uint16  number of values
+ *     float   the value of every parameter, in its own range, in PARAMETER_ORDER
+ *
+ * all little-endian. The order is fixed: new parameters are only ever appended
+ * (and the version bumped), so a state written by an older build just leaves
+ * the newer parameters at their defaults and a newer one's extra values are
+ * skipped. Reading is a single pass over the values, no XML and no ValueTree.
+*/
+class PresetFormat {
+public:
+    static constexpr juce::uint16 VERSION = 1;
+
+    // Resolves the parameters once, in the fixed order
+    explicit PresetFormat(juce::AudioProcessorValueTreeState& apvts);
+
+    // The current parameter values
+    void write(juce::MemoryBlock& destData) const;
+
+    // Sets every parameter from a binary state, the ones it does not cover go back
+    // to their defaults. False if the data is not a binary state at all.
+    bool read(const void* data, size_t sizeInBytes) const;
+
+    static bool isBinaryState(const void* data, size_t sizeInBytes) noexcept;
+
+private:
+    std::vector<juce::RangedAudioParameter*> parameters;
+};
@@ -0,0 +1,218 @@
+/*
+  ==============================================================================
+
+    PresetLibrary.cpp
+    Created: 18 Oct 2026 2:31:07am
+    Author:  Norb
+
+  ==============================================================================
+*/
+
+#include "PresetLibrary.h"
+
+namespace {
+    const juce::uint32 MAGIC = juce::ByteOrder::littleEndianInt("SYPL");
+    constexpr size_t HEADER_SIZE = 16;
+    constexpr size_t ENTRY_SIZE = PresetLibrary::NAME_LENGTH + 12;
+
+    // a zero padded, possibly unterminated, UTF-8 field
+    juce::String readText(const char* field, int length)
+    {
+        int used = 0;
+        while (used < length && field[used] != 0) used++;
+        return juce::String::fromUTF8(field, used);
+    }
+
+    void writeText(juce::OutputStream& stream, const juce::String& text, int length)
+    {
+        char field[PresetLibrary::NAME_LENGTH] = {};
+        text.copyToUTF8(field, (size_t)length);
+        stream.write(field, (size_t)length);
+    }
+
+    bool fits(const juce::String& text, int length)
+    {
+        // copyToUTF8 needs room for the terminator
+        return text.isNotEmpty() && (int)text.getNumBytesAsUTF8() < length;
+    }
+}
+
+juce::File PresetLibrary::getDefaultFile()
+{
+    return juce::File::getSpecialLocation(juce::File::userApplicationDataDirectory)
+        .getChildFile("Syrberus").getChildFile("Presets.syrlib");
+}
+
+bool PresetLibrary::open(const juce::File& file)
+{
+    close();
+
+    auto mapping = std::make_unique<juce::MemoryMappedFile>(file, juce::MemoryMappedFile::readOnly);
+    const auto* data = static_cast<const char*>(mapping->getData());
+    const size_t size = mapping->getSize();
+
+    if (data == nullptr || size < HEADER_SIZE || juce::ByteOrder::littleEndianInt(data) != MAGIC
+        || juce::ByteOrder::littleEndianInt(data + 4) > VERSION)
+        return false;
+
+    const size_t numTags = juce::ByteOrder::littleEndianInt(data + 8);
+    const size_t numPresets = juce::ByteOrder::littleEndianInt(data + 12);
+    const size_t entriesStart = HEADER_SIZE + numTags * TAG_LENGTH;
+
+    if (numTags > MAX_TAGS || entriesStart + numPresets * ENTRY_SIZE > size)
+        return false;
+
+    for (size_t t = 0; t < numTags; t++) {
+        tags.add(readText(data + HEADER_SIZE + t * TAG_LENGTH, TAG_LENGTH));
+    }
+
+    entries.reserve(numPresets);
+    for (size_t i = 0; i < numPresets; i++) {
+        const char* entry = data + entriesStart + i * ENTRY_SIZE;
+        const size_t offset = juce::ByteOrder::littleEndianInt(entry + NAME_LENGTH + 4);
+        const size_t length = juce::ByteOrder::littleEndianInt(entry + NAME_LENGTH + 8);
+
+        // a damaged file is refused whole rather than half loaded
+        if (offset > size || length > size - offset) {
+            close();
+            return false;
+        }
+
+        entries.push_back({ readText(entry, NAME_LENGTH), juce::ByteOrder::littleEndianInt(entry + NAME_LENGTH), data + offset, length });
+        byName.emplace(entries.back().name, (int)i);
+    }
+
+    mapped = std::move(mapping);
+    return true;
+}
+
+void PresetLibrary::close()
+{
+    entries.clear();
+    tags.clear();
+    byName.clear();
+    mapped.reset();
+}
+
+juce::String PresetLibrary::getName(int index) const
+{
+    return juce::isPositiveAndBelow(index, getNumPresets()) ? entries[(size_t)index].name : juce::String();
+}
+
+juce::StringArray PresetLibrary::getTags(int index) const
+{
+    juce::StringArray result;
+    if (!juce::isPositiveAndBelow(index, getNumPresets())) return result;
+
+    for (int t = 0; t < tags.size(); t++) {
+        if ((entries[(size_t)index].tagMask & (1u << t)) != 0)
+            result.add(tags[t]);
+    }
+
+    return result;
+}
+
+int PresetLibrary::indexOf(const juce::String& name) const
+{
+    auto found = byName.find(name);
+    return found != byName.end() ? found->second : -1;
+}
+
+std::vector<int> PresetLibrary::getPresetsWithTag(const juce::String& tag) const
+{
+    std::vector<int> result;
+
+    const int t = tags.indexOf(tag);
+    if (t < 0) return result;
+
+    for (size_t i = 0; i < entries.size(); i++) {
+        if ((entries[i].tagMask & (1u << t)) != 0)
+            result.push_back((int)i);
+    }
+
+    return result;
+}
+
+bool PresetLibrary::getState(int index, const void*& data, size_t& sizeInBytes) const
+{
+    if (!juce::isPositiveAndBelow(index, getNumPresets())) return false;
+
+    data = entries[(size_t)index].state;
+    sizeInBytes = entries[(size_t)index].size;
+    return true;
+}
+
+//==============================================================================
+juce::Result PresetLibrary::Builder::add(const juce::String& name, const juce::StringArray& presetTags, const juce::MemoryBlock& state)
+{
+    if (!fits(name, NAME_LENGTH))
+        return juce::Result::fail("Preset name \"" + name + "\" is empty or too long");
+
+    if (names.count(name) != 0)
+        return juce::Result::fail("There is already a preset called \"" + name + "\"");
+
+    // the new tags only join the table once the preset is accepted
+    auto newTagNames = tagNames;
+    juce::uint32 mask = 0;
+
+    for (auto& tag : presetTags) {
+        if (!fits(tag, TAG_LENGTH))
+            return juce::Result::fail("Tag \"" + tag + "\" of preset \"" + name + "\" is too long");
+
+        int t = newTagNames.indexOf(tag);
+        if (t < 0) {
+            if (newTagNames.size() == MAX_TAGS)
+                return juce::Result::fail("Preset \"" + name + "\" would make more than " + juce::String(MAX_TAGS) + " tags");
+
+            t = newTagNames.size();
+            newTagNames.add(tag);
+        }
+
+        mask |= 1u << t;
+    }
+
+    tagNames = newTagNames;
+    names.insert(name);
+    presets.push_back({ name, mask, state });
+    return juce::Result::ok();
+}
+
+juce::Result PresetLibrary::Builder::writeTo(const juce::File& file) const
+{
+    juce::MemoryOutputStream stream;
+
+    stream.writeInt((int)MAGIC);
+    stream.writeInt((int)VERSION);
+    stream.writeInt(tagNames.size());
+    stream.writeInt((int)presets.size());
+
+    for (auto& tag : tagNames) {
+        writeText(stream, tag, TAG_LENGTH);
+    }
+
+    size_t offset = HEADER_SIZE + (size_t)tagNames.size() * TAG_LENGTH + presets.size() * ENTRY_SIZE;
+    for (auto& preset : presets) {
+        writeText(stream, preset.name, NAME_LENGTH);
+        stream.writeInt((int)preset.tagMask);
+        stream.writeInt((int)offset);
+        stream.writeInt((int)preset.state.getSize());
+        offset += preset.state.getSize();
+    }
+
+    for (auto& preset : presets) {
+        stream.write(preset.state.getData(), preset.state.getSize());
+    }
+
+    // Written beside the old library and renamed over it. On POSIX a plugin that has the
+    // old one mapped keeps reading the old file; Windows refuses to replace a mapped file.
+    juce::TemporaryFile temporary(file);
+
+    if (!temporary.getFile().replaceWithData(stream.getData(), stream.getDataSize()))
+        return juce::Result::fail("Could not write " + temporary.getFile().getFullPathName());
+
+    if (!temporary.overwriteTargetFileWithTemporary())
+        return juce::Result::fail("Could not replace " + file.getFullPathName()
+                                  + ", close any plugin or host that has it open and try again");
+
+    return juce::Result::ok();
+}
@@ -0,0 +1,88 @@
+/*
+  ==============================================================================
+
+    PresetLibrary.h
+    Created: 18 Oct 2026 2:31:07am
+    Author:  Norb
+
+  ==============================================================================
+*/
+
+#pragma once
+#include <JuceHeader.h>
+
+/*
+ * A whole preset library in one file, memory-mapped read-only:
+ *
+ *     header    "SYPL", uint32 version, uint32 tag count, uint32 preset count
+ *     tags      tag count x char[TAG_LENGTH], UTF-8, zero padded
+ *     entries   preset count x { char[NAME_LENGTH] name, uint32 tag mask,
+ *                                uint32 state offset, uint32 state size }
+ *     states    every preset's PresetFormat state, back to back
+ *
+ * all little-endian. Opening maps the file and indexes the names and tags once;
+ * after that finding a preset is a hash lookup and its state is read straight
+ * out of the mapping, so every instance of the plugin shares the same pages.
+*/
+class PresetLibrary {
+public:
+    static constexpr juce::uint32 VERSION = 1;
+    static constexpr int NAME_LENGTH = 64;
+    static constexpr int TAG_LENGTH = 32;
+    static constexpr int MAX_TAGS = 32;
+
+    // Where the plugin looks for its library
+    static juce::File getDefaultFile();
+
+    bool open(const juce::File& file);
+    void close();
+    bool isOpen() const noexcept { return mapped != nullptr; }
+
+    int getNumPresets() const noexcept { return (int)entries.size(); }
+    juce::String getName(int index) const;
+    juce::StringArray getTags(int index) const;
+
+    // -1 if there is no such preset
+    int indexOf(const juce::String& name) const;
+
+    // The presets carrying the tag, in library order
+    std::vector<int> getPresetsWithTag(const juce::String& tag) const;
+
+    // The preset's PresetFormat state, pointing into the mapped file
+    bool getState(int index, const void*& data, size_t& sizeInBytes) const;
+
+    // Collects presets and writes them out as a library file
+    class Builder {
+    public:
+        // Fails if the name is taken (names are looked up, so they must be unique), or
+        // if the name or a tag is too long, or there would be too many tags
+        juce::Result add(const juce::String& name, const juce::StringArray& tags, const juce::MemoryBlock& state);
+
+        // Fails if the file cannot be written or, on Windows, while a running plugin has it open
+        juce::Result writeTo(const juce::File& file) const;
+
+    private:
+        struct Preset {
+            juce::String name;
+            juce::uint32 tagMask;
+            juce::MemoryBlock state;
+        };
+
+        juce::StringArray tagNames;
+        std::vector<Preset> presets;
+        std::unordered_set<juce::String> names;
+    };
+
+private:
+    struct Entry {
+        juce::String name;
+        juce::uint32 tagMask;
+        const char* state;
+        size_t size;
+    };
+
+    std::unique_ptr<juce::MemoryMappedFile> mapped;
+    std::vector<Entry> entries;
+    juce::StringArray tags;
+    std::unordered_map<juce::String, int> byName;
+};
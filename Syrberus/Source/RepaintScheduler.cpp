@@ -0,0 +1,45 @@
+/*
+  ==============================================================================
+
+    RepaintScheduler.cpp
+    Created: 18 Oct 2026 1:12:44am
+    Author:  Norb
+
+  ==============================================================================
+*/
+
+#include "RepaintScheduler.h"
+
+RepaintScheduler::~RepaintScheduler()
+{
+    stopTimer();
+}
+
+void RepaintScheduler::add(juce::Component& component, int maxHz, Poll hasChanged)
+{
+    jassert(hasChanged != nullptr);
+    clients.push_back({ &component, (juce::uint32)(1000 / juce::jlimit(1, TICK_HZ, maxHz)), std::move(hasChanged) });
+
+    if (!isTimerRunning())
+        startTimerHz(TICK_HZ);
+}
+
+void RepaintScheduler::timerCallback()
+{
+    const auto now = juce::Time::getMillisecondCounter();
+
+    for (auto& client : clients) {
+        // throttled, whatever changed meanwhile is picked up on a later tick
+        if (now - client.lastPaint < client.intervalMs)
+            continue;
+
+        // the poll also runs on the first tick, so it starts from what is painted
+        const bool changed = client.hasChanged();
+        if (!changed && !client.firstPaint)
+            continue;
+
+        client.firstPaint = false;
+        client.lastPaint = now;
+        client.component->repaint();
+    }
+}
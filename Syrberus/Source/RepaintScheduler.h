@@ -0,0 +1,46 @@
+/*
+  ==============================================================================
+
+    RepaintScheduler.h
+    Created: 18 Oct 2026 1:12:44am
+    Author:  Norb
+
+  ==============================================================================
+*/
+
+#pragma once
+#include <JuceHeader.h>
+
+/*
+ * Repaints components when something they show has changed, and no more often
+ * than each one's maximum rate.
+ *
+ * Every component registers a poll that is asked, on the message thread, whether
+ * its data moved since it last looked; changes in between are picked up by the
+ * next poll. One timer serves all of them; when nothing changes a tick is a
+ * handful of atomic loads and nothing gets painted.
+*/
+class RepaintScheduler : private juce::Timer {
+public:
+    using Poll = std::function<bool()>;
+
+    ~RepaintScheduler() override;
+
+    // Message thread, maxHz is at most TICK_HZ
+    void add(juce::Component& component, int maxHz, Poll hasChanged);
+
+private:
+    static constexpr int TICK_HZ = 60;
+
+    struct Client {
+        juce::Component* component;
+        juce::uint32 intervalMs;
+        Poll hasChanged;
+        juce::uint32 lastPaint = 0;
+        bool firstPaint = true;
+    };
+
+    void timerCallback() override;
+
+    std::vector<Client> clients;
+};
@@ -0,0 +1,62 @@
+/*
+  ==============================================================================
+
+    ScopeBuffer.cpp
+    Created: 18 Oct 2026 12:36:20am
+    Author:  Norb
+
+  ==============================================================================
+*/
+
+#include "ScopeBuffer.h"
+
+void ScopeBuffer::push(const float* left, const float* right, int numSamples) noexcept
+{
+    if (!isEnabled()) return;
+
+    // a block longer than the ring only leaves its end behind
+    if (numSamples > CAPACITY) {
+        const int skip = numSamples - CAPACITY;
+        left += skip;
+        if (right != nullptr) right += skip;
+        numSamples = CAPACITY;
+    }
+
+    const juce::uint64 start = written.load(std::memory_order_relaxed);
+
+    // announced before any slot changes, the fence keeps the stores below after it
+    writing.store(start + (juce::uint64)numSamples, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+
+    for (int i = 0; i < numSamples; i++) {
+        const float value = right != nullptr ? 0.5f * (left[i] + right[i]) : left[i];
+        samples[(start + (juce::uint64)i) & MASK].store(value, std::memory_order_relaxed);
+    }
+
+    written.store(start + (juce::uint64)numSamples, std::memory_order_release);
+}
+
+int ScopeBuffer::readLatest(float* dest, int numSamples) const noexcept
+{
+    numSamples = juce::jlimit(0, CAPACITY / 2, numSamples);
+
+    const juce::uint64 end = written.load(std::memory_order_acquire);
+    const juce::uint64 available = juce::jmin(end, (juce::uint64)numSamples);
+    const juce::uint64 start = end - available;
+    const int missing = numSamples - (int)available;
+
+    // before the first samples arrived there is only silence
+    std::fill(dest, dest + missing, 0.0f);
+
+    for (juce::uint64 i = 0; i < available; i++) {
+        dest[missing + (int)i] = samples[(start + i) & MASK].load(std::memory_order_relaxed);
+    }
+
+    // whatever the writer got to, or started on, while we were copying is not to be trusted
+    std::atomic_thread_fence(std::memory_order_acquire);
+    const juce::uint64 now = writing.load(std::memory_order_relaxed);
+    const juce::uint64 overwritten = now > start + CAPACITY ? now - (start + CAPACITY) : 0;
+
+    if (overwritten >= available) return 0;
+    return (int)(available - overwritten);
+}
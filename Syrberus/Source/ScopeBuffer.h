@@ -0,0 +1,54 @@
+/*
+  ==============================================================================
+
+    ScopeBuffer.h
+    Created: 18 Oct 2026 12:36:20am
+    Author:  Norb
+
+  ==============================================================================
+*/
+
+#pragma once
+#include <JuceHeader.h>
+
+/*
+ * The last CAPACITY samples of the plugin's output, for the oscilloscope.
+ *
+ * Single producer (the audio thread), single consumer (the editor). The writer
+ * never waits and never checks on the reader: it announces how far it is about
+ * to write, overwrites the oldest samples and then publishes how far it got.
+ * The reader copies out what it wants and afterwards checks against the
+ * announced position that none of it was overwritten meanwhile, including by
+ * a block still being written.
+ *
+ * Nothing is written unless an editor has asked for it with setEnabled, so a
+ * closed editor costs the audio thread one atomic load per block.
+*/
+class ScopeBuffer {
+public:
+    static constexpr int CAPACITY = 1 << 14;
+
+    // Audio thread only, once per block. Stereo is folded to mono.
+    void push(const float* left, const float* right, int numSamples) noexcept;
+
+    // Any thread
+    void setEnabled(bool shouldCapture) noexcept { enabled.store(shouldCapture, std::memory_order_relaxed); }
+    bool isEnabled() const noexcept { return enabled.load(std::memory_order_relaxed); }
+    double getSampleRate() const noexcept { return sampleRate.load(std::memory_order_relaxed); }
+    void setSampleRate(double newSampleRate) noexcept { sampleRate.store(newSampleRate, std::memory_order_relaxed); }
+
+    // Reader only. Copies the newest numSamples (at most CAPACITY / 2) into dest,
+    // oldest first. Returns how many of them are valid, counted from the end.
+    int readLatest(float* dest, int numSamples) const noexcept;
+
+private:
+    static constexpr juce::uint64 MASK = CAPACITY - 1;
+
+    // plain floats behind atomic accesses, a torn read is caught by the check against writing
+    std::atomic<float> samples[CAPACITY] {};
+    std::atomic<juce::uint64> written { 0 };   // samples complete
+    std::atomic<juce::uint64> writing { 0 };   // samples that may have been overwritten by now
+
+    std::atomic<bool> enabled { false };
+    std::atomic<double> sampleRate { 44100.0 };
+};
@@ -0,0 +1,64 @@
+/*
+  ==============================================================================
+
+    SeqLock.h
+    Created: 18 Oct 2026 3:12:44am
+    Author:  Norb
+
+  ==============================================================================
+*/
+
+#pragma once
+#include <JuceHeader.h>
+
+/*
+ * A sequence lock for values published by one writer and read from any thread.
+ *
+ * The values themselves are atomics owned by the caller, stored and loaded
+ * relaxed inside write() and read(). The sequence is odd while the writer is
+ * storing them, a reader that saw it odd or changed just reads again. The writer
+ * never waits, a reader only ever waits for a write already in progress.
+*/
+class SeqLock {
+public:
+    // Writer only. storeValues() does the relaxed stores.
+    template <typename StoreValues>
+    void write(StoreValues&& storeValues) noexcept {
+        const auto start = sequence.load(std::memory_order_relaxed);
+        sequence.store(start + 1, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_release);
+
+        storeValues();
+
+        sequence.store(start + 2, std::memory_order_release);
+    }
+
+    // Any thread. loadValues() does the relaxed loads into a copy, which is only
+    // consistent once this returns. Returns the version that was read.
+    template <typename LoadValues>
+    juce::uint32 read(LoadValues&& loadValues) const noexcept {
+        for (;;) {
+            const auto before = sequence.load(std::memory_order_acquire);
+
+            if ((before & 1) == 0) {
+                loadValues();
+
+                std::atomic_thread_fence(std::memory_order_acquire);
+
+                if (sequence.load(std::memory_order_relaxed) == before)
+                    return before;
+            }
+
+            // the writer is mid-write, it will be done in a moment
+            juce::Thread::yield();
+        }
+    }
+
+    // Changes with every write
+    juce::uint32 getVersion() const noexcept {
+        return sequence.load(std::memory_order_acquire);
+    }
+
+private:
+    std::atomic<juce::uint32> sequence { 0 };
+};
@@ -15,11 +15,6 @@ void ShapeSelectButton::initShapeSelect(juce::AudioProcessorValueTreeState& tree
     this->shapeId = shapeId;
     this->apvts = &treeState;
     parameterId = paramId;
-    treeState.addParameterListener(parameterId, this);
-
-    // force the initial state update
-    bool toggleOn = static_cast<int>(std::round(apvts->getParameter(parameterId)->getValue() * 4)) == shapeId;
-    setToggleState(toggleOn, false);
 
     onStateChange = [&]()
         {
@@ -27,17 +22,6 @@ void ShapeSelectButton::initShapeSelect(juce::AudioProcessorValueTreeState& tree
         };
 }
 
-void ShapeSelectButton::parameterChanged(const juce::String& parameterId, float newValue)
-{
-    // is the parameter value my shape id?
-    bool toggleOn = static_cast<int>(std::round(newValue)) == shapeId;
-
-    juce::MessageManager::callAsync([&]() {
-            setToggleState(toggleOn, false);
-            repaint();
-        });
-}
-
 void ShapeSelectButton::toggleChanged()
 {
     // change the parameter
@@ -46,6 +30,43 @@ void ShapeSelectButton::toggleChanged()
         apvts->getParameter(parameterId)->setValue(shapeId / 4.0f);
 }
 
+//==============================================================================
+ShapeSelectGroup::~ShapeSelectGroup()
+{
+    if (apvts) apvts->removeParameterListener(parameterId, this);
+    cancelPendingUpdate();
+}
+
+void ShapeSelectGroup::attach(juce::AudioProcessorValueTreeState& treeState, const juce::String& paramId,
+                              std::initializer_list<ShapeSelectButton*> groupButtons)
+{
+    apvts = &treeState;
+    parameterId = paramId;
+    buttons = groupButtons;
+    treeState.addParameterListener(parameterId, this);
+
+    // force the initial state update
+    latestShape = static_cast<int>(std::round(apvts->getRawParameterValue(parameterId)->load()));
+    handleAsyncUpdate();
+}
+
+void ShapeSelectGroup::parameterChanged(const juce::String&, float newValue)
+{
+    // any thread, possibly many times a block: only the newest value matters
+    latestShape.store(static_cast<int>(std::round(newValue)), std::memory_order_relaxed);
+    triggerAsyncUpdate();
+}
+
+void ShapeSelectGroup::handleAsyncUpdate()
+{
+    const int shape = latestShape.load(std::memory_order_relaxed);
+
+    for (auto* button : buttons) {
+        // no notification, this is the parameter talking, not a click
+        button->setToggleState(button->getShapeId() == shape, juce::dontSendNotification);
+    }
+}
+
 void ShapeSelectButton::paint(juce::Graphics& g) {
     auto bounds = getLocalBounds().toFloat();
     bool isOn = getToggleState();
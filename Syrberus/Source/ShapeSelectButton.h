@@ -12,22 +12,44 @@
 
 #include <JuceHeader.h>
 
-class ShapeSelectButton : public juce::ToggleButton, public juce::AudioProcessorValueTreeState::Listener
+// One of an oscillator's shape buttons. Clicking it sets the shape, following
+// the parameter is left to the ShapeSelectGroup the buttons belong to.
+class ShapeSelectButton : public juce::ToggleButton
 {
 public:
-    ~ShapeSelectButton() override
-    {
-        if (!apvts) return;
-        apvts->removeParameterListener(parameterId, this);
-    }
-
     void initShapeSelect(juce::AudioProcessorValueTreeState& treeState, const juce::String& paramId, int shapeId);
-    void parameterChanged(const juce::String& parameterId, float newValue) override;
     void toggleChanged();
     void paint(juce::Graphics& g) override;
+    int getShapeId() const { return shapeId; }
 
 private:
     int shapeId;
     juce::AudioProcessorValueTreeState* apvts = nullptr;
     juce::String parameterId;
+};
+
+/*
+ * Keeps a radio group of shape buttons in step with their parameter.
+ *
+ * One listener for the whole group: a change only stores the newest shape and
+ * triggers an async update, so however fast a host automates the shape, the
+ * buttons are updated at most once per message loop round, from the latest value.
+*/
+class ShapeSelectGroup : private juce::AudioProcessorValueTreeState::Listener,
+                         private juce::AsyncUpdater
+{
+public:
+    ~ShapeSelectGroup() override;
+
+    void attach(juce::AudioProcessorValueTreeState& treeState, const juce::String& paramId,
+                std::initializer_list<ShapeSelectButton*> groupButtons);
+
+private:
+    void parameterChanged(const juce::String& parameterId, float newValue) override;
+    void handleAsyncUpdate() override;
+
+    juce::AudioProcessorValueTreeState* apvts = nullptr;
+    juce::String parameterId;
+    std::vector<ShapeSelectButton*> buttons;
+    std::atomic<int> latestShape { 0 };
 };
\ No newline at end of file
@@ -10,48 +10,72 @@
 
 #include "SyrberusSynth.h"
 
-bool SyrberusSound::appliesToNote(int) { return true; }
-bool SyrberusSound::appliesToChannel(int) { return true; }
+void SyrberusVoice::startNote(int midiNoteNumber, int midiChannel, juce::uint32 noteOrder, int offset)
+{
+    currentNote = midiNoteNumber;
+    currentChannel = midiChannel;
+    order = noteOrder;
+    keyDown = true;
+    sustained = false;
+
+    queueEvent({ offset, NOTE_ON, midiNoteNumber });
+}
+
+void SyrberusVoice::stopNote(bool allowTailOff, int offset)
+{
+    keyDown = false;
+    sustained = false;
+    queueEvent({ offset, allowTailOff ? NOTE_OFF : NOTE_CUT, currentNote });
+}
 
-bool SyrberusVoice::canPlaySound(juce::SynthesiserSound* sound)
+bool SyrberusVoice::isPlayingNote(int midiNoteNumber, int midiChannel) const noexcept
 {
-    return dynamic_cast<SyrberusSound*> (sound) != nullptr;
+    return currentNote == midiNoteNumber && currentChannel == midiChannel;
 }
 
-void SyrberusVoice::startNote(int midiNoteNumber, float velocity, juce::SynthesiserSound*, int)
+bool SyrberusVoice::wasStartedBefore(const SyrberusVoice& other) const noexcept
 {
-    osc.setFrequency(juce::MidiMessage::getMidiNoteInHertz(midiNoteNumber));
-    //syrOsc.setFrequency(juce::MidiMessage::getMidiNoteInHertz(midiNoteNumber));
-    syrOsc.setKey(midiNoteNumber);
-    adsr.noteOn();
-    envelope.noteOn();
+    return order < other.order;
 }
 
-void SyrberusVoice::stopNote(float, bool allowTailOff)
+void SyrberusVoice::queueEvent(NoteEvent event)
 {
-    adsr.noteOff();
-    envelope.noteOff();
+    // the synthesiser renders before a queue can fill, see hasRoomForMidiMessage
+    jassert(numEvents < MAX_EVENTS);
+    if (numEvents == MAX_EVENTS)
+        numEvents--;
+
+    events[numEvents++] = event;
+}
 
-    if (!allowTailOff) {
-        clearCurrentNote();
+void SyrberusVoice::setOversampling(int factor)
+{
+    if (isVoiceActive()) {
+        pendingOversampling = factor;
+        return;
     }
+
+    syrOsc.setOversampling(factor);
+    pendingOversampling = 0;
 }
 
 void SyrberusVoice::prepareToPlay(double sampleRate, int samplesPerBlock, int outputChannels)
 {
-    voiceBuffer.setSize(outputChannels, samplesPerBlock, false, false, true);
-    adsr.setSampleRate(sampleRate);
-    envelope.setSampleRate(sampleRate);
+    envelope.prepare(sampleRate);
 
     juce::dsp::ProcessSpec spec;
     spec.maximumBlockSize = samplesPerBlock;
     spec.sampleRate = sampleRate;
     spec.numChannels = outputChannels;
-    osc.prepare(spec);
     syrOsc.prepare(spec);
 
-    gain.prepare(spec);
-    gain.setRampDurationSeconds(0.005f);
+    // preparing restarts the oscillators anyway
+    if (pendingOversampling != 0) {
+        syrOsc.setOversampling(pendingOversampling);
+        pendingOversampling = 0;
+    }
+
+    gain.reset(sampleRate, 0.005);
 
     isPrepared = true;
 }
@@ -59,78 +83,430 @@ void SyrberusVoice::prepareToPlay(double sampleRate, int samplesPerBlock, int ou
 
 void SyrberusVoice::updateParams(float normalizedGain, dubu::EnvelopeGraph* envelopeGraph)
 {
-    gain.setGainLinear(normalizedGain);
+    gain.setTargetValue(normalizedGain);
     envelope.setGraph(envelopeGraph);
-    
-    // We gonna get rid of this one
-    adsrParams.attack = envelopeGraph->attack;
-    adsrParams.decay = envelopeGraph->decay;
-    adsrParams.sustain = envelopeGraph->sustain;
-    adsrParams.release = envelopeGraph->release;
-    adsr.setParameters(adsrParams);
 }
 
 void SyrberusVoice::setUnison(int voices, float detune) {
     syrOsc.setUnison(voices, detune);
 }
 
-void SyrberusVoice::updateParams(UnisonVoice::SyrberusOscillatorParams params)
+void SyrberusVoice::updateParams(const UnisonBank::SyrberusOscillatorParams& params)
 {
     syrOsc.updateParams(params);
 }
 
-void SyrberusVoice::renderNextBlock(juce::AudioBuffer<float>& outputBuffer, int startSample, int numSamples)
+float SyrberusVoice::getCurrentLevel() const
 {
-    jassert(isPrepared);
+    return envelope.getCurrentGain();
+}
+
+int SyrberusVoice::getActiveLayerCount() const noexcept
+{
+    return syrOsc.getActiveLayerCount();
+}
 
+void SyrberusVoice::applySnapshot(const ParameterSnapshot& params, dubu::EnvelopeGraph* envelopeGraph)
+{
+    // only re-derive the groups that moved since the last block
+    if (params.generation.gain != applied.gain || params.generation.envelope != applied.envelope)
+        updateParams(params.gain, envelopeGraph);
+
+    if (params.generation.oscillators != applied.oscillators)
+        updateParams(params.oscillators);
+
+    if (params.generation.unison != applied.unison)
+        setUnison(params.unisonCount, params.unisonDetune);
+
+    applied = params.generation;
+}
+
+void SyrberusVoice::wake(const ParameterSnapshot& params, dubu::EnvelopeGraph* envelopeGraph)
+{
+    applySnapshot(params, envelopeGraph);
+
+    // nothing was heard while asleep, so there is nothing to smooth from
+    gain.setCurrentAndTargetValue(gain.getTargetValue());
+    syrOsc.reset();
+}
+
+void SyrberusVoice::renderNextBlock(juce::AudioBuffer<float>& outputBuffer, int startSample, int numSamples)
+{
     if (!isVoiceActive()) {
         return;
     }
-    
 
-    //juce::dsp::AudioBlock<float> audioBlock{ outputBuffer };
-    //osc.process(juce::dsp::ProcessContextReplacing<float>(audioBlock));
-    //gain.process(juce::dsp::ProcessContextReplacing<float>(audioBlock));
-    //adsr.applyEnvelopeToBuffer(outputBuffer, startSample, numSamples);
+    float* left = outputBuffer.getWritePointer(0, startSample);
+    float* right = outputBuffer.getNumChannels() > 1 ? outputBuffer.getWritePointer(1, startSample) : nullptr;
+    render(left, right, scratch.gains, numSamples);
+    finishBlock();
+}
+
+void SyrberusVoice::renderVoice(int numSamples, const VoiceScratch& slice) noexcept
+{
+    juce::FloatVectorOperations::clear(slice.left, numSamples);
+    juce::FloatVectorOperations::clear(slice.right, numSamples);
+    render(slice.left, slice.right, slice.gains, numSamples);
+}
+
+void SyrberusVoice::mixInto(juce::AudioBuffer<float>& outputBuffer, int startSample, int numSamples, const VoiceScratch& slice)
+{
+    if (outputBuffer.getNumChannels() > 1) {
+        outputBuffer.addFrom(0, startSample, slice.left, numSamples);
+        outputBuffer.addFrom(1, startSample, slice.right, numSamples);
+    } else {
+        outputBuffer.addFrom(0, startSample, slice.left, numSamples, 0.5f);
+        outputBuffer.addFrom(0, startSample, slice.right, numSamples, 0.5f);
+    }
+
+    finishBlock();
+}
+
+void SyrberusVoice::finishBlock()
+{
+    // the voice is free again once the release has finished
+    if (!envelope.isActive())
+        currentNote = -1;
+}
+
+void SyrberusVoice::applyEvent(const NoteEvent& event) noexcept
+{
+    switch (event.type) {
+        case NOTE_ON:
+            // the new note restarts the oscillators anyway, a deferred rate change goes in with it
+            if (pendingOversampling != 0) {
+                syrOsc.setOversampling(pendingOversampling);
+                pendingOversampling = 0;
+            }
+
+            syrOsc.setKey(event.note);
+            envelope.noteOn();
+            break;
+        case NOTE_OFF:
+            envelope.noteOff();
+            break;
+        case NOTE_CUT:
+            envelope.reset();
+            break;
+    }
+}
+
+void SyrberusVoice::render(float* left, float* right, float* gains, int numSamples) noexcept
+{
+    jassert(isPrepared);
+
+    int position = 0;
+    int next = 0;
+
+    while (position < numSamples) {
+        while (next < numEvents && events[next].offset <= position) {
+            applyEvent(events[next++]);
+        }
+
+        const bool wasActive = envelope.isActive();
+
+        // releases only change the envelope, so the gains are written around them;
+        // a note start resets the oscillators, the run ends there
+        int written = position;
+        while (next < numEvents && events[next].type != NOTE_ON && events[next].offset < numSamples) {
+            envelope.getNextGains(gains + written, events[next].offset - written);
+            written = events[next].offset;
+            applyEvent(events[next++]);
+        }
+
+        const int end = next < numEvents ? juce::jlimit(position + 1, numSamples, events[next].offset) : numSamples;
+
+        // nothing is playing until the next note start
+        if (!wasActive && written == position) {
+            position = end;
+            continue;
+        }
+
+        envelope.getNextGains(gains + written, end - written);
+
+        // the whole per-sample gain of the voice, worked out once and applied by the
+        // oscillators as they sum into the output
+        const int length = end - position;
+        if (gain.isSmoothing()) {
+            for (int i = position; i < end; i++) {
+                gains[i] *= gain.getNextValue();
+            }
+        } else {
+            juce::FloatVectorOperations::multiply(gains + position, gain.getTargetValue(), length);
+        }
+
+        syrOsc.process(left + position, right != nullptr ? right + position : nullptr, gains + position, length);
+        position = end;
+    }
+
+    // anything left was queued past the end of the block
+    while (next < numEvents) {
+        applyEvent(events[next++]);
+    }
+
+    numEvents = 0;
+}
+
+//==============================================================================
+void SyrberusSynthesiser::prepare(double sampleRate, int samplesPerBlock, int outputChannels)
+{
+    // HeapBlock only promises malloc's alignment, so the arena is over-allocated and its
+    // start rounded up. Slice lengths are whole multiples of the alignment, so every
+    // slice starts aligned too.
+    constexpr int floatsPerAlignment = (int)(SCRATCH_ALIGNMENT / sizeof(float));
+    scratchLength = (samplesPerBlock + floatsPerAlignment - 1) & ~(floatsPerAlignment - 1);
+    scratchArena.allocate((size_t)(3 * scratchLength * MAX_POLYPHONY + floatsPerAlignment - 1), true);
+
+    const auto address = reinterpret_cast<std::uintptr_t>(scratchArena.get());
+    alignedScratch = reinterpret_cast<float*>((address + SCRATCH_ALIGNMENT - 1) & ~(std::uintptr_t)(SCRATCH_ALIGNMENT - 1));
+
+    for (auto& voice : voices) {
+        voice.prepareToPlay(sampleRate, samplesPerBlock, outputChannels);
+        voice.setScratch(getScratch(0));
+    }
+}
+
+VoiceScratch SyrberusSynthesiser::getScratch(int slice) noexcept
+{
+    float* start = alignedScratch + 3 * scratchLength * slice;
+    return VoiceScratch { start, start + scratchLength, start + 2 * scratchLength };
+}
+
+void SyrberusSynthesiser::setPolyphony(int maxVoices)
+{
+    polyphony = juce::jlimit(1, (int)MAX_POLYPHONY, maxVoices);
+}
+
+void SyrberusSynthesiser::setOversampling(int factor)
+{
+    if (factor == oversampling) return;
+
+    oversampling = factor;
+
+    for (auto& voice : voices) {
+        voice.setOversampling(factor);
+    }
+}
+
+void SyrberusSynthesiser::applySnapshot(const ParameterSnapshot& params, dubu::EnvelopeGraph* graph) noexcept
+{
+    snapshot = &params;
+    envelopeGraph = graph;
 
+    for (auto& voice : voices) {
+        if (voice.isVoiceActive())
+            voice.applySnapshot(params, graph);
+    }
+}
 
-    /*if (voiceBuffer.getNumSamples() != numSamples) {
-        voiceBuffer.setSize(outputBuffer.getNumChannels(), numSamples, false, false, true);
+void SyrberusSynthesiser::countActive(int& numVoices, int& numLayers) const noexcept
+{
+    numVoices = 0;
+    numLayers = 0;
+
+    for (auto& voice : voices) {
+        if (voice.isVoiceActive()) {
+            numVoices++;
+            numLayers += voice.getActiveLayerCount();
+        }
     }
-    jassert(voiceBuffer.getNumSamples() == numSamples);*/
-    
-    voiceBuffer.clear(0, numSamples);
-    juce::dsp::AudioBlock<float> audioBlock { voiceBuffer };
+}
+
+std::unique_ptr<VoiceRenderPool> SyrberusSynthesiser::createRenderPool()
+{
+    // leave one core for the host's own audio thread
+    auto pool = std::make_unique<VoiceRenderPool>();
+    pool->start(juce::jmin(juce::SystemStats::getNumCpus() - 1, (int)VoiceRenderPool::MAX_WORKERS));
+    return pool;
+}
+
+std::unique_ptr<VoiceRenderPool> SyrberusSynthesiser::swapRenderPool(std::unique_ptr<VoiceRenderPool> pool) noexcept
+{
+    std::swap(renderPool, pool);
+    return pool;
+}
+
+void SyrberusSynthesiser::renderNextBlock(juce::AudioBuffer<float>& outputAudio, const juce::MidiBuffer& midiData,
+                                          int startSample, int numSamples)
+{
+    jassert(scratchLength > 0); // prepare() first
+
+    auto midiIterator = midiData.findNextSamplePosition(startSample);
 
-    // So every other function accepts `numSamples` as an argument. Great!
-    // But turns out the oscillator `process` function taking in an audioBlock, does not.
-    // Instead I had to use `audioBlock.getSubBlock` to limit it to `numSamples`.
-    // Took me 12 hours to figure out this was my issue all along. All I was having
-    // is random crackling noises.
-    //osc.process(juce::dsp::ProcessContextReplacing<float>(audioBlock.getSubBlock(0, numSamples))); // correct numSamples?
-    syrOsc.process(voiceBuffer, 0, numSamples);
-    gain.process(juce::dsp::ProcessContextReplacing<float>(audioBlock));
+    while (numSamples > 0) {
+        // the scratch slices are one prepared block long, hosts that send more get it in pieces
+        int length = juce::jmin(numSamples, scratchLength);
 
+        // hand every event of this piece to the voices first...
+        for (; midiIterator != midiData.cend(); ++midiIterator) {
+            const auto metadata = *midiIterator;
+            const int offset = juce::jmax(0, metadata.samplePosition - startSample);
+            if (offset >= length) break;
 
-    //adsr.applyEnvelopeToBuffer(voiceBuffer, 0, numSamples);
-    envelope.applyToBuffer(voiceBuffer, 0, numSamples);
+            // ...unless a voice's queue is full, then the piece ends here and the rest of
+            // the events start the next one. A queue filled by events on the piece's
+            // first sample can't be cut before them, the next message moves a sample later.
+            if (!allVoicesHaveRoom()) {
+                length = juce::jmax(1, offset);
+                break;
+            }
 
-    for (int channel = 0; channel < outputBuffer.getNumChannels(); channel++)
-    {
-        outputBuffer.addFrom(channel, startSample, voiceBuffer, channel, 0, numSamples);
+            handleMidiEvent(metadata.getMessage(), offset);
+        }
+
+        // ...then render each voice once over all of it
+        renderVoices(outputAudio, startSample, length);
+
+        startSample += length;
+        numSamples -= length;
     }
+}
+
+void SyrberusSynthesiser::handleMidiEvent(const juce::MidiMessage& message, int offset)
+{
+    const int channel = message.getChannel();
 
-    if (!envelope.isActive()) {
-        clearCurrentNote();
+    if (message.isNoteOn()) {
+        noteOn(channel, message.getNoteNumber(), offset);
+    } else if (message.isNoteOff()) {
+        noteOff(channel, message.getNoteNumber(), offset);
+    } else if (message.isAllNotesOff()) {
+        allNotesOff(true, offset);
+    } else if (message.isAllSoundOff()) {
+        allNotesOff(false, offset);
+    } else if (message.isSustainPedalOn()) {
+        handleSustainPedal(true, offset);
+    } else if (message.isSustainPedalOff()) {
+        handleSustainPedal(false, offset);
     }
 }
 
-void SyrberusVoice::pitchWheelMoved(int newPitchWheelValue)
+bool SyrberusSynthesiser::allVoicesHaveRoom() const noexcept
 {
+    for (auto& voice : voices) {
+        if (!voice.hasRoomForMidiMessage())
+            return false;
+    }
 
+    return true;
 }
 
-void SyrberusVoice::controllerMoved(int controllerNumber, int newControllerValue)
+void SyrberusSynthesiser::noteOn(int midiChannel, int midiNoteNumber, int offset)
 {
+    // a note still ringing, say from the pedal, is let go before it is played again
+    for (auto& voice : voices) {
+        if (voice.isPlayingNote(midiNoteNumber, midiChannel) && !voice.isPlayingButReleased())
+            voice.stopNote(true, offset);
+    }
+
+    auto* voice = findFreeVoice();
+    if (voice == nullptr)
+        voice = findVoiceToSteal();
+
+    if (voice == nullptr)
+        return;
 
-}
\ No newline at end of file
+    // a stolen voice is already up to date
+    if (!voice->isVoiceActive() && snapshot != nullptr)
+        voice->wake(*snapshot, envelopeGraph);
+
+    voice->startNote(midiNoteNumber, midiChannel, ++noteCounter, offset);
+}
+
+void SyrberusSynthesiser::noteOff(int midiChannel, int midiNoteNumber, int offset)
+{
+    for (auto& voice : voices) {
+        if (voice.isPlayingNote(midiNoteNumber, midiChannel) && voice.isKeyDown()) {
+            if (sustainPedalDown)
+                voice.sustain();
+            else
+                voice.stopNote(true, offset);
+        }
+    }
+}
+
+void SyrberusSynthesiser::allNotesOff(bool allowTailOff, int offset)
+{
+    for (auto& voice : voices) {
+        if (voice.isVoiceActive())
+            voice.stopNote(allowTailOff, offset);
+    }
+
+    sustainPedalDown = false;
+}
+
+void SyrberusSynthesiser::handleSustainPedal(bool isDown, int offset)
+{
+    sustainPedalDown = isDown;
+
+    if (isDown) return;
+
+    for (auto& voice : voices) {
+        if (voice.isVoiceActive() && voice.isSustained())
+            voice.stopNote(true, offset);
+    }
+}
+
+void SyrberusSynthesiser::renderVoices(juce::AudioBuffer<float>& outputAudio, int startSample, int numSamples)
+{
+    int numActive = 0;
+    for (auto& voice : voices) {
+        if (voice.isVoiceActive()) {
+            activeScratch[numActive] = getScratch(numActive);
+            activeVoices[numActive++] = &voice;
+        }
+    }
+
+    if (!parallelRendering || renderPool == nullptr || renderPool->getNumWorkers() == 0 || numSamples < MIN_PARALLEL_SAMPLES || numActive < 2) {
+        for (int i = 0; i < numActive; i++) {
+            activeVoices[i]->renderNextBlock(outputAudio, startSample, numSamples);
+        }
+        return;
+    }
+
+    // every voice renders into its own slice of the arena, the sum is always done in
+    // voice order on this thread so the output does not depend on the scheduling
+    renderPool->render(activeVoices, activeScratch, numActive, numSamples);
+
+    for (int i = 0; i < numActive; i++) {
+        activeVoices[i]->mixInto(outputAudio, startSample, numSamples, activeScratch[i]);
+    }
+}
+
+SyrberusVoice* SyrberusSynthesiser::findFreeVoice() noexcept
+{
+    // voices past the polyphony limit are left to finish whatever they were playing
+    for (int i = 0; i < polyphony; i++) {
+        if (!voices[i].isVoiceActive())
+            return &voices[i];
+    }
+
+    return nullptr;
+}
+
+SyrberusVoice* SyrberusSynthesiser::findVoiceToSteal() noexcept
+{
+    // Prefer the quietest voice that is already releasing, it is the least likely
+    // to be missed. Failing that, take the oldest held note.
+    SyrberusVoice* quietestReleasing = nullptr;
+    SyrberusVoice* oldest = nullptr;
+
+    for (int i = 0; i < polyphony; i++) {
+        auto* voice = &voices[i];
+
+        if (voice->isPlayingButReleased()) {
+            if (quietestReleasing == nullptr
+                || voice->getCurrentLevel() < quietestReleasing->getCurrentLevel()
+                || (voice->getCurrentLevel() == quietestReleasing->getCurrentLevel() && voice->wasStartedBefore(*quietestReleasing)))
+                quietestReleasing = voice;
+        }
+
+        if (oldest == nullptr || voice->wasStartedBefore(*oldest))
+            oldest = voice;
+    }
+
+    if (quietestReleasing != nullptr)
+        return quietestReleasing;
+
+    return oldest;
+}
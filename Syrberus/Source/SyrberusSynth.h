@@ -9,45 +9,195 @@
 */
 
 #pragma once
-#include <juce_audio_processors/juce_audio_processors.h>
-#include <juce_audio_basics/juce_audio_basics.h>
 #include <JuceHeader.h>
 #include "SyrberusOscillator.h"
-#include "SyrberusOscillator.h"
 #include "Envelope.h"
+#include "ParameterCache.h"
+#include "VoiceRenderPool.h"
 
-// Represents a basic synth sound
-class SyrberusSound : public juce::SynthesiserSound
-{
-public:
-    bool appliesToNote(int) override;
-    bool appliesToChannel(int) override;
+// A voice's share of the synthesiser's scratch arena, each one maximumBlockSize long
+struct VoiceScratch {
+    float* gains;   // volume times envelope, one per sample
+    float* left;    // only used when the voice renders on a worker thread
+    float* right;
 };
 
-// Generates a sine wave for each note played
-class SyrberusVoice : public juce::SynthesiserVoice
+/*
+ * Plays one note. Note events arrive as a queue of sample offsets for the block
+ * ahead and are applied while rendering, so a voice always renders its whole
+ * block in one call however many events land in it. Only a note start breaks
+ * the oscillator loop, releases just change the envelope.
+*/
+class SyrberusVoice final
 {
 public:
-    bool canPlaySound(juce::SynthesiserSound* sound) override;
-    void startNote(int midiNoteNumber, float velocity, juce::SynthesiserSound*, int) override;
-    void stopNote(float, bool allowTailOff) override;
     void prepareToPlay(double sampleRate, int samplesPerBlock, int outputChannels);
     void setUnison(int voices, float detune);
+    // Changing the rate restarts the oscillators and their filters, so a sounding
+    // voice keeps its rate until its next note starts
+    void setOversampling(int factor);
     void updateParams(float normalizedGain, dubu::EnvelopeGraph* envelopeGraph);
-    void updateParams(UnisonVoice::SyrberusOscillatorParams params);
-    void renderNextBlock(juce::AudioBuffer<float>& outputBuffer, int startSample, int numSamples) override;
-    void pitchWheelMoved(int newPitchWheelValue) override;
-    void controllerMoved(int controllerNumber, int newControllerValue) override;
+    void updateParams(const UnisonBank::SyrberusOscillatorParams& params);
+    float getCurrentLevel() const;
+    int getActiveLayerCount() const noexcept;
+    void applySnapshot(const ParameterSnapshot& params, dubu::EnvelopeGraph* envelopeGraph);
+
+    // Brings a sleeping voice up to date before it plays again. Idle voices get no
+    // snapshots, so whatever moved meanwhile is applied here and the smoothed
+    // values jump straight to where they should be
+    void wake(const ParameterSnapshot& params, dubu::EnvelopeGraph* envelopeGraph);
+
+    void setScratch(const VoiceScratch& scratchToUse) { scratch = scratchToUse; }
+
+    // Note events for the coming block, the offsets must not go backwards
+    void startNote(int midiNoteNumber, int midiChannel, juce::uint32 noteOrder, int offset);
+    void stopNote(bool allowTailOff, int offset);
+
+    // Note state as of the queued events
+    bool isVoiceActive() const noexcept { return currentNote >= 0; }
+    bool isPlayingButReleased() const noexcept { return isVoiceActive() && !keyDown && !sustained; }
+    bool isPlayingNote(int midiNoteNumber, int midiChannel) const noexcept;
+    bool wasStartedBefore(const SyrberusVoice& other) const noexcept;
+
+    bool isKeyDown() const noexcept { return keyDown; }
+
+    // Whether the events of another MIDI message still fit in this block. One message
+    // queues at most two on a voice: a retriggered note is stopped, then stolen.
+    bool hasRoomForMidiMessage() const noexcept { return numEvents <= MAX_EVENTS - 2; }
+
+    // The key came up while the sustain pedal was down, the note plays on until the pedal is lifted
+    void sustain() noexcept { keyDown = false; sustained = true; }
+    bool isSustained() const noexcept { return sustained; }
+
+    // Renders straight into the output: oscillators, pan, volume and envelope in one pass
+    void renderNextBlock(juce::AudioBuffer<float>& outputBuffer, int startSample, int numSamples);
+
+    // The parallel version of renderNextBlock. renderVoice only touches this voice and
+    // its own slice of the arena, so voices can be rendered on worker threads; mixInto
+    // then sums the slice into the output.
+    void renderVoice(int numSamples, const VoiceScratch& slice) noexcept;
+    void mixInto(juce::AudioBuffer<float>& outputBuffer, int startSample, int numSamples, const VoiceScratch& slice);
 
 private:
+    enum EventType { NOTE_ON, NOTE_OFF, NOTE_CUT };
+
+    struct NoteEvent {
+        int offset;
+        EventType type;
+        int note;
+    };
+
+    // A voice only gets a handful of events per block. Once its queue is full the
+    // synthesiser renders what came before, so the queue never overflows.
+    enum { MAX_EVENTS = 16 };
+
+    void queueEvent(NoteEvent event);
+    void applyEvent(const NoteEvent& event) noexcept;
+    void render(float* left, float* right, float* gains, int numSamples) noexcept;
+    void finishBlock();
+
     dubu::Envelope envelope;
-    juce::ADSR adsr;
-    juce::ADSR::Parameters adsrParams;
-    juce::AudioBuffer<float> voiceBuffer;
+    VoiceScratch scratch {};
 
-    juce::dsp::Oscillator<float> osc{ [](float x) { return std::sin(x); } };
     SyrberusOscillator syrOsc;
-    juce::dsp::Gain<float> gain;
+    juce::SmoothedValue<float> gain;
     bool isPrepared = false;
+
+    // note state, as seen by the synthesiser when it allocates voices
+    int currentNote = -1;
+    int currentChannel = 0;
+    juce::uint32 order = 0;
+    bool keyDown = false;
+    bool sustained = false;
+
+    NoteEvent events[MAX_EVENTS];
+    int numEvents = 0;
+    int pendingOversampling = 0;    // applied at the next note start, 0 for none
+
+    // generations of the last snapshot pushed into this voice, 0 is never issued
+    ParameterSnapshot::Generations applied { 0, 0, 0, 0 };
 };
 
+/*
+ * Turns MIDI into voice events and renders the voices, in place of juce::Synthesiser.
+ *
+ * juce::Synthesiser splits the block at every MIDI event and renders every voice once
+ * per piece, so a busy arpeggio leaves the oscillators running in tiny loops. Here all
+ * the events of a block are handed out first, as offsets into the block, and every
+ * voice is then rendered once for the whole block.
+ *
+ * All MAX_POLYPHONY voices live in the synthesiser itself, the polyphony setting only
+ * limits how many of them new notes may use.
+*/
+class SyrberusSynthesiser
+{
+public:
+    enum { MAX_POLYPHONY = 64 };
+
+    // Prepares every voice and sizes the scratch arena they share
+    void prepare(double sampleRate, int samplesPerBlock, int outputChannels);
+    void setPolyphony(int maxVoices);
+    int getPolyphony() const { return polyphony; }
+
+    // Pushes the parameter groups that changed into the voices that are playing, call
+    // once per block. Idle voices sleep and catch up from the snapshot on their next note.
+    void applySnapshot(const ParameterSnapshot& params, dubu::EnvelopeGraph* envelopeGraph) noexcept;
+
+    // Adds the voices on top of outputAudio, playing the MIDI at its sample positions
+    void renderNextBlock(juce::AudioBuffer<float>& outputAudio, const juce::MidiBuffer& midiData,
+                         int startSample, int numSamples);
+
+    // Voices playing and the unison layers they render, for the performance counters
+    void countActive(int& numVoices, int& numLayers) const noexcept;
+
+    // Worker threads for parallel rendering. Starting and joining threads can take a
+    // while, so a pool is built and destroyed by the caller and only the swap has to
+    // happen between blocks. Returns the pool that was in use, if any.
+    static std::unique_ptr<VoiceRenderPool> createRenderPool();
+    std::unique_ptr<VoiceRenderPool> swapRenderPool(std::unique_ptr<VoiceRenderPool> pool) noexcept;
+    bool hasRenderPool() const noexcept { return renderPool != nullptr; }
+    void setParallelRendering(bool shouldRenderInParallel) { parallelRendering = shouldRenderInParallel; }
+
+    // Oscillator oversampling, 1, 2 or 4. Free voices switch straight away, sounding
+    // ones at their next note, so nothing that can be heard is restarted.
+    void setOversampling(int factor);
+
+private:
+    // Below this many samples dispatching to the workers costs more than it saves
+    enum { MIN_PARALLEL_SAMPLES = 64 };
+
+    void handleMidiEvent(const juce::MidiMessage& message, int offset);
+    bool allVoicesHaveRoom() const noexcept;
+    void noteOn(int midiChannel, int midiNoteNumber, int offset);
+    void noteOff(int midiChannel, int midiNoteNumber, int offset);
+    void allNotesOff(bool allowTailOff, int offset);
+    void handleSustainPedal(bool isDown, int offset);
+
+    SyrberusVoice* findFreeVoice() noexcept;
+    SyrberusVoice* findVoiceToSteal() noexcept;
+    void renderVoices(juce::AudioBuffer<float>& outputAudio, int startSample, int numSamples);
+    VoiceScratch getScratch(int slice) noexcept;
+
+    SyrberusVoice voices[MAX_POLYPHONY];
+
+    // the latest snapshot, sleeping voices wake up from it
+    const ParameterSnapshot* snapshot = nullptr;
+    dubu::EnvelopeGraph* envelopeGraph = nullptr;
+
+    int polyphony = 8;
+    bool sustainPedalDown = false;
+    juce::uint32 noteCounter = 0;
+
+    bool parallelRendering = false;
+    int oversampling = 1;
+    std::unique_ptr<VoiceRenderPool> renderPool;
+    SyrberusVoice* activeVoices[MAX_POLYPHONY];
+    VoiceScratch activeScratch[MAX_POLYPHONY];
+
+    // One slice per voice (gains, left, right), serial rendering only uses the first
+    juce::HeapBlock<float> scratchArena;
+    float* alignedScratch = nullptr;    // scratchArena rounded up to SCRATCH_ALIGNMENT
+    int scratchLength = 0;
+
+    static constexpr size_t SCRATCH_ALIGNMENT = 32;
+};
@@ -0,0 +1,387 @@
+/*
+  ==============================================================================
+
+    UnisonBank.cpp
+    Created: 17 Oct 2026 10:12:41am
+    Author:  Norb
+
+  ==============================================================================
+*/
+
+#include "UnisonBank.h"
+#include "WaveKernels.h"
+
+namespace {
+    template <UnisonBank::WaveType type, typename T>
+    inline T waveAt(T p) noexcept
+    {
+        if (type == UnisonBank::SINE)        return WaveKernels::sine(p);
+        if (type == UnisonBank::SQUARE)      return WaveKernels::square(p);
+        if (type == UnisonBank::TRIANGLE)    return WaveKernels::triangle(p);
+        if (type == UnisonBank::SAW)         return WaveKernels::saw(p);
+        return WaveKernels::sineSquare(p);
+    }
+
+    template <UnisonBank::WaveType type, typename T>
+    inline T waveAt(T p, T dt, T invDt) noexcept
+    {
+        if (type == UnisonBank::SQUARE)      return WaveKernels::squareBandLimited(p, dt, invDt);
+        if (type == UnisonBank::SAW)         return WaveKernels::sawBandLimited(p, dt, invDt);
+        if (type == UnisonBank::SINE_SQUARE) return WaveKernels::sineSquareBandLimited(p, dt, invDt);
+        return waveAt<type>(p);
+    }
+
+    inline float wrap(float p) noexcept
+    {
+        return p - std::floor(p);
+    }
+}
+
+UnisonBank::UnisonBank()
+{
+    for (int o = 0; o < NUM_OSCILLATORS; o++) {
+        waveType[o] = SINE;
+        phase[o] = 0.0f;
+        transpose[o] = 0;
+        bandLimited[o] = false;
+        level[o] = levelTarget[o] = levelStep[o] = 0.0f;
+        levelRampLeft[o] = 0;
+    }
+
+    juce::FloatVectorOperations::clear(phases, NUM_OSCILLATORS * LANES);
+    juce::FloatVectorOperations::clear(increments, NUM_OSCILLATORS * LANES);
+    juce::FloatVectorOperations::fill(blepWidths, 0.5f, NUM_OSCILLATORS * LANES);
+    juce::FloatVectorOperations::fill(blepScales, 2.0f, NUM_OSCILLATORS * LANES);
+    juce::FloatVectorOperations::clear(laneGainLeft, NUM_OSCILLATORS * LANES);
+    juce::FloatVectorOperations::clear(laneGainRight, NUM_OSCILLATORS * LANES);
+
+    setUnison(1, 0.0f);
+}
+
+void UnisonBank::prepare(const juce::dsp::ProcessSpec& spec)
+{
+    sampleRate = spec.sampleRate;
+
+    levelRampLength = juce::jmax(1, (int)std::round(LEVEL_RAMP_SECONDS * sampleRate));
+
+    // like SmoothedValue::reset, any ramp in progress is finished
+    for (int o = 0; o < NUM_OSCILLATORS; o++) {
+        level[o] = levelTarget[o];
+        levelRampLeft[o] = 0;
+        updateLaneGains(o);
+    }
+
+    updateIncrements();
+}
+
+void UnisonBank::reset() noexcept
+{
+    for (int o = 0; o < NUM_OSCILLATORS; o++) {
+        level[o] = levelTarget[o];
+        levelRampLeft[o] = 0;
+        updateLaneGains(o);
+    }
+
+    resetPhases();
+}
+
+void UnisonBank::setKey(int midiKey)
+{
+    currentKey = midiKey;
+    updateIncrements();
+    resetPhases();
+}
+
+void UnisonBank::setUnison(int newUnisonCount, float newDetune)
+{
+    newUnisonCount = juce::jlimit(1, (int)MAX_UNISON, newUnisonCount);
+
+    if (newUnisonCount == unisonCount && newDetune == detune)
+        return;
+
+    unisonCount = newUnisonCount;
+    detune = newDetune;
+
+    for (int u = 0; u < LANES; u++) {
+        float pan = 0.0f;
+
+        if (u >= unisonCount) {
+            // unused lanes are silenced rather than skipped
+            unisonPhase[u] = 0.0f;
+            unisonDetune[u] = 0.0f;
+            panLeft[u] = 0.0f;
+            panRight[u] = 0.0f;
+            continue;
+        }
+
+        if (unisonCount == 1) {
+            unisonPhase[u] = 0.0f;
+            unisonDetune[u] = 0.0f;
+        } else {
+            float t = ((float)u / (float)(unisonCount - 1));
+
+            unisonPhase[u] = 1.0f - t * (0.5f);
+            unisonDetune[u] = (-0.5f * detune) + t * detune;
+            pan = -0.5f + t;
+        }
+
+        // balanced pan rule, same as juce::dsp::PannerRule::balanced
+        panLeft[u] = juce::jmin(1.0f, 1.0f - pan);
+        panRight[u] = juce::jmin(1.0f, 1.0f + pan);
+    }
+
+    for (int o = 0; o < NUM_OSCILLATORS; o++) {
+        updateLaneGains(o);
+    }
+
+    updateIncrements();
+}
+
+void UnisonBank::setLevels(const float gains[])
+{
+    // we will adjust the gains by treating them as weights
+    float totalWeight = gains[0] + gains[1] + gains[2];
+    if (totalWeight < 1.0f) totalWeight = 1.0f; // min total weight of 1 to allow shaping of single osc
+
+    for (int o = 0; o < NUM_OSCILLATORS; o++) {
+        const float target = gains[o] / totalWeight;
+        if (target == levelTarget[o]) continue;
+
+        // ramps from wherever the level is, even halfway through another ramp
+        levelTarget[o] = target;
+        levelStep[o] = (target - level[o]) / (float)levelRampLength;
+        levelRampLeft[o] = levelRampLength;
+    }
+}
+
+void UnisonBank::updateLaneGains(int osc) noexcept
+{
+    juce::FloatVectorOperations::multiply(laneGainLeft + osc * LANES, panLeft, level[osc], (int)LANES);
+    juce::FloatVectorOperations::multiply(laneGainRight + osc * LANES, panRight, level[osc], (int)LANES);
+}
+
+void UnisonBank::setAntiAliasing(bool shouldBandLimit)
+{
+    if (shouldBandLimit == antiAliasing) return;
+
+    antiAliasing = shouldBandLimit;
+    updateBandLimiting();
+}
+
+void UnisonBank::updateParams(const SyrberusOscillatorParams& params)
+{
+    bool transposeChanged = false;
+
+    for (int o = 0; o < NUM_OSCILLATORS; o++) {
+        // shapes
+        waveType[o] = params.osc[o].type;
+
+        // phase, shift the running lanes by the difference
+        if (params.osc[o].phase != phase[o]) {
+            float offset = params.osc[o].phase - phase[o];
+            phase[o] = params.osc[o].phase;
+
+            float* lane = phases + o * LANES;
+            for (int u = 0; u < LANES; u++) {
+                lane[u] = wrap(lane[u] + offset);
+            }
+        }
+
+        // transpose
+        if (params.osc[o].transpose != transpose[o]) {
+            transpose[o] = params.osc[o].transpose;
+            transposeChanged = true;
+        }
+    }
+
+    if (transposeChanged) updateIncrements();
+
+    // gains
+    float gains[NUM_OSCILLATORS]{
+        params.osc[0].gain, params.osc[1].gain, params.osc[2].gain
+    };
+    setLevels(gains);
+
+    setAntiAliasing(params.antiAliasing);
+}
+
+void UnisonBank::updateIncrements()
+{
+    if (currentKey < 0) return;
+
+    for (int o = 0; o < NUM_OSCILLATORS; o++) {
+        for (int u = 0; u < unisonCount; u++) {
+            const int lane = o * LANES + u;
+
+            // fractional semitones, so the detune spread is not rounded away
+            float note = (float)currentKey + (float)transpose[o] + unisonDetune[u];
+            float frequency = 440.0f * std::exp2((note - 69.0f) / 12.0f);
+            increments[lane] = (float)(frequency / sampleRate);
+
+            blepWidths[lane] = juce::jmin(increments[lane], 0.5f);
+            blepScales[lane] = 1.0f / blepWidths[lane];
+        }
+    }
+
+    updateBandLimiting();
+}
+
+void UnisonBank::updateBandLimiting()
+{
+    // Picked per note: the kernel is chosen from the highest lane of each oscillator
+    for (int o = 0; o < NUM_OSCILLATORS; o++) {
+        const float* lane = increments + o * LANES;
+        float highest = 0.0f;
+
+        for (int u = 0; u < unisonCount; u++) {
+            highest = juce::jmax(highest, lane[u]);
+        }
+
+        bandLimited[o] = antiAliasing && highest > BAND_LIMIT_MIN_INCREMENT;
+    }
+}
+
+void UnisonBank::resetPhases()
+{
+    for (int o = 0; o < NUM_OSCILLATORS; o++) {
+        float* lane = phases + o * LANES;
+
+        for (int u = 0; u < LANES; u++) {
+            lane[u] = wrap(phase[o] + unisonPhase[u]);
+        }
+    }
+}
+
+bool UnisonBank::isOscillatorSilent(int osc) const noexcept
+{
+    return levelTarget[osc] == 0.0f && levelRampLeft[osc] == 0;
+}
+
+int UnisonBank::getActiveLayerCount() const noexcept
+{
+    int layers = 0;
+
+    for (int o = 0; o < NUM_OSCILLATORS; o++) {
+        if (!isOscillatorSilent(o)) layers += unisonCount;
+    }
+
+    return layers;
+}
+
+void UnisonBank::skipOscillator(int osc, int numSamples) noexcept
+{
+    // keep the phases moving so the oscillator comes back in tune when it is unmuted
+    float* lanePhase = phases + osc * LANES;
+    const float* laneIncrement = increments + osc * LANES;
+
+    for (int u = 0; u < unisonCount; u++) {
+        lanePhase[u] = wrap(lanePhase[u] + laneIncrement[u] * (float)numSamples);
+    }
+}
+
+void UnisonBank::process(float* left, float* right, const float* voiceGains, int numSamples) noexcept
+{
+    for (int o = 0; o < NUM_OSCILLATORS; o++) {
+        if (isOscillatorSilent(o)) {
+            skipOscillator(o, numSamples);
+            continue;
+        }
+
+        switch (waveType[o]) {
+            case SINE:          renderOscillator<SINE>(o, left, right, voiceGains, numSamples); break;
+            case SQUARE:        renderOscillator<SQUARE>(o, left, right, voiceGains, numSamples); break;
+            case TRIANGLE:      renderOscillator<TRIANGLE>(o, left, right, voiceGains, numSamples); break;
+            case SAW:           renderOscillator<SAW>(o, left, right, voiceGains, numSamples); break;
+            case SINE_SQUARE:   renderOscillator<SINE_SQUARE>(o, left, right, voiceGains, numSamples); break;
+        }
+    }
+}
+
+template <UnisonBank::WaveType type>
+void UnisonBank::renderOscillator(int osc, float* left, float* right, const float* voiceGains, int numSamples) noexcept
+{
+    // sine and triangle have no jumps to correct
+    const bool hasEdges = type == SQUARE || type == SAW || type == SINE_SQUARE;
+
+    if (hasEdges && bandLimited[osc])
+        renderOscillator<type, true>(osc, left, right, voiceGains, numSamples);
+    else
+        renderOscillator<type, false>(osc, left, right, voiceGains, numSamples);
+}
+
+template <UnisonBank::WaveType type, bool withBlep>
+void UnisonBank::renderOscillator(int osc, float* left, float* right, const float* voiceGains, int numSamples) noexcept
+{
+    int done = 0;
+
+    // the lane gains only move while a level change is ramping, and then in a straight line
+    if (levelRampLeft[osc] > 0) {
+        done = juce::jmin(levelRampLeft[osc], numSamples);
+        renderLanes<type, withBlep, true>(osc, left, right, voiceGains, done);
+
+        levelRampLeft[osc] -= done;
+        level[osc] = levelRampLeft[osc] > 0 ? level[osc] + levelStep[osc] * (float)done : levelTarget[osc];
+        updateLaneGains(osc);
+    }
+
+    if (done < numSamples)
+        renderLanes<type, withBlep, false>(osc, left + done, right != nullptr ? right + done : nullptr, voiceGains + done, numSamples - done);
+}
+
+template <UnisonBank::WaveType type, bool withBlep, bool ramping>
+void UnisonBank::renderLanes(int osc, float* left, float* right, const float* voiceGains, int numSamples) noexcept
+{
+    using WaveKernels::Lanes;
+    using WaveKernels::laneWidth;
+
+    float* lanePhase = phases + osc * LANES;
+    const float* laneIncrement = increments + osc * LANES;
+    const float* laneWidths = blepWidths + osc * LANES;
+    const float* laneScales = blepScales + osc * LANES;
+    const float* gainLeft = laneGainLeft + osc * LANES;
+    const float* gainRight = laneGainRight + osc * LANES;
+    const float step = levelStep[osc];
+
+    // whole registers only, the padding lanes have no pan gain so they add nothing
+    const int numGroups = (unisonCount + laneWidth - 1) / laneWidth;
+    const Lanes zero = WaveKernels::splat(0.0f, Lanes());
+
+    for (int s = 0; s < numSamples; s++) {
+        Lanes sumLeft = zero;
+        Lanes sumRight = zero;
+
+        // while ramping, sample s is (s + 1) steps along from the lane gains
+        const Lanes rampOffset = WaveKernels::splat(step * (float)(s + 1), zero);
+
+        for (int g = 0; g < numGroups; g++) {
+            const int lane = g * laneWidth;
+            Lanes p = WaveKernels::load(lanePhase + lane, zero);
+            Lanes wave = withBlep ? waveAt<type>(p, WaveKernels::load(laneWidths + lane, zero), WaveKernels::load(laneScales + lane, zero))
+                                  : waveAt<type>(p);
+
+            Lanes toLeft = WaveKernels::load(gainLeft + lane, zero);
+            Lanes toRight = WaveKernels::load(gainRight + lane, zero);
+
+            if (ramping) {
+                toLeft = toLeft + WaveKernels::load(panLeft + lane, zero) * rampOffset;
+                toRight = toRight + WaveKernels::load(panRight + lane, zero) * rampOffset;
+            }
+
+            sumLeft = sumLeft + wave * toLeft;
+            sumRight = sumRight + wave * toRight;
+
+            p = WaveKernels::fraction(p + WaveKernels::load(laneIncrement + lane, zero));
+            WaveKernels::store(lanePhase + lane, p);
+        }
+
+        // voice volume and envelope, the oscillator's pan and level are already in the lane gains
+        const float gain = voiceGains[s];
+
+        if (right != nullptr) {
+            left[s] += gain * WaveKernels::sum(sumLeft);
+            right[s] += gain * WaveKernels::sum(sumRight);
+        } else {
+            left[s] += gain * 0.5f * WaveKernels::sum(sumLeft + sumRight);
+        }
+    }
+}
@@ -0,0 +1,136 @@
+/*
+  ==============================================================================
+
+    UnisonBank.h
+    Created: 17 Oct 2026 10:12:41am
+    Author:  Norb
+
+  ==============================================================================
+*/
+
+#pragma once
+#include <JuceHeader.h>
+
+/*
+ * Renders every unison layer of all three oscillators for a single voice.
+ *
+ * Instead of one processor chain (oscillator, panner, gain) per layer, all of the
+ * per-layer state lives in flat arrays. Lane `u` of oscillator `o` sits at
+ * `o * LANES + u`, so a whole oscillator is rendered by one tight loop over its
+ * unison lanes, straight into the stereo output.
+ *
+ * The pan law and the oscillator's level are folded into one left/right gain
+ * per lane, worked out when the unison or the levels change, so the loop only
+ * multiplies each lane by its pair of gains.
+*/
+class UnisonBank {
+public:
+    enum {
+        MAX_UNISON = 17,
+        NUM_OSCILLATORS = 3,
+        LANES = 24 // MAX_UNISON rounded up to whole SSE/AVX registers
+    };
+
+    enum WaveType {
+        SINE,
+        SQUARE,
+        TRIANGLE,
+        SAW,
+        SINE_SQUARE
+    };
+
+    struct OscillatorParams {
+        WaveType type;
+        int transpose;
+        float gain;
+        float phase;
+        float stereo;
+        bool invert;
+    };
+
+    struct SyrberusOscillatorParams {
+        OscillatorParams osc[NUM_OSCILLATORS];
+        bool antiAliasing;
+    };
+
+    UnisonBank();
+
+    void prepare(const juce::dsp::ProcessSpec& spec);
+    void reset() noexcept;
+
+    void setKey(int midiKey);
+    void setUnison(int unisonCount, float detune);
+    void setLevels(const float gains[]);
+    void setAntiAliasing(bool shouldBandLimit);
+    void updateParams(const SyrberusOscillatorParams& params);
+
+    // Adds all oscillators and their unison layers on top of left/right, scaled by
+    // one gain per sample (the voice's envelope and volume). With no right channel
+    // the output is folded to mono.
+    void process(float* left, float* right, const float* voiceGains, int numSamples) noexcept;
+
+    int getUnisonCount() const noexcept { return unisonCount; }
+
+    // An oscillator with its Mix at zero is not rendered at all
+    bool isOscillatorSilent(int osc) const noexcept;
+
+    // Unison layers that actually get rendered, across all oscillators
+    int getActiveLayerCount() const noexcept;
+
+private:
+    void updateIncrements();
+    void updateBandLimiting();
+    void resetPhases();
+    void skipOscillator(int osc, int numSamples) noexcept;
+
+    void updateLaneGains(int osc) noexcept;
+
+    template <WaveType type, bool withBlep, bool ramping>
+    void renderLanes(int osc, float* left, float* right, const float* voiceGains, int numSamples) noexcept;
+
+    template <WaveType type, bool withBlep>
+    void renderOscillator(int osc, float* left, float* right, const float* voiceGains, int numSamples) noexcept;
+
+    template <WaveType type>
+    void renderOscillator(int osc, float* left, float* right, const float* voiceGains, int numSamples) noexcept;
+
+    // level changes are ramped over ~5ms
+    static constexpr double LEVEL_RAMP_SECONDS = 0.005;
+
+    // Below this increment (~43Hz at 44.1kHz) the naive shapes fold back so little
+    // that the PolyBLEP correction is not worth its cost
+    static constexpr float BAND_LIMIT_MIN_INCREMENT = 1.0f / 1024.0f;
+
+    // per-lane state, normalised phase in the [0, 1) range
+    alignas(32) float phases[NUM_OSCILLATORS * LANES];
+    alignas(32) float increments[NUM_OSCILLATORS * LANES];
+    alignas(32) float blepWidths[NUM_OSCILLATORS * LANES];   // increment, capped at half a cycle
+    alignas(32) float blepScales[NUM_OSCILLATORS * LANES];   // 1 / blepWidths
+
+    // pan times level, what the render loop actually applies to each lane
+    alignas(32) float laneGainLeft[NUM_OSCILLATORS * LANES];
+    alignas(32) float laneGainRight[NUM_OSCILLATORS * LANES];
+
+    // per-unison-layer state, shared by all oscillators
+    alignas(32) float panLeft[LANES];
+    alignas(32) float panRight[LANES];
+    float unisonDetune[LANES];
+    float unisonPhase[LANES];
+
+    // per-oscillator state
+    float level[NUM_OSCILLATORS];         // where the level is, the lane gains are built from this
+    float levelTarget[NUM_OSCILLATORS];
+    float levelStep[NUM_OSCILLATORS];     // per sample while ramping
+    int levelRampLeft[NUM_OSCILLATORS];   // samples
+    int levelRampLength = 220;
+    WaveType waveType[NUM_OSCILLATORS];
+    float phase[NUM_OSCILLATORS];
+    int transpose[NUM_OSCILLATORS];
+    bool bandLimited[NUM_OSCILLATORS];
+
+    bool antiAliasing = true;
+    int unisonCount = 0;
+    float detune = 0.0f;
+    int currentKey = -1;
+    double sampleRate = 44100.0;
+};
@@ -0,0 +1,171 @@
+/*
+  ==============================================================================
+
+    VoiceRenderPool.cpp
+    Created: 17 Oct 2026 8:21:54pm
+    Author:  Norb
+
+  ==============================================================================
+*/
+
+#include "VoiceRenderPool.h"
+#include "SyrberusSynth.h"
+
+#if JUCE_INTEL
+ #include <immintrin.h>
+#endif
+
+namespace {
+    // tells the core this is a spin loop, so it saves power and leaves the pipeline to its sibling
+    inline void pauseHint() noexcept
+    {
+       #if JUCE_INTEL
+        _mm_pause();
+       #elif JUCE_ARM && JUCE_MSVC
+        __yield();
+       #elif JUCE_ARM
+        __asm__ __volatile__("yield");
+       #endif
+    }
+}
+
+VoiceRenderPool::~VoiceRenderPool()
+{
+    stop();
+}
+
+void VoiceRenderPool::start(int numWorkers)
+{
+    numWorkers = juce::jlimit(0, (int)MAX_WORKERS, numWorkers);
+    if (numWorkers == workers.size()) return;
+
+    stop();
+
+    // The audio thread waits for every job a worker has claimed, so a worker the OS
+    // may preempt in favour of ordinary threads would put the deadline at its mercy.
+    // Without realtime scheduling there are no workers and rendering stays serial.
+    for (int i = 0; i < numWorkers; i++) {
+        std::unique_ptr<Worker> worker(new Worker(*this, i));
+
+        if (!worker->startRealtimeThread(juce::Thread::RealtimeOptions {}))
+            break;
+
+        workers.add(worker.release());
+    }
+}
+
+void VoiceRenderPool::stop()
+{
+    for (auto* worker : workers) {
+        worker->signalThreadShouldExit();
+        worker->wake();
+    }
+
+    for (auto* worker : workers) {
+        worker->stopThread(1000);
+    }
+
+    workers.clear();
+}
+
+void VoiceRenderPool::render(SyrberusVoice* const* voices, const VoiceScratch* slices, int numVoices, int numSamples) noexcept
+{
+    jassert(numVoices <= MAX_JOBS);
+    numVoices = juce::jmin(numVoices, (int)MAX_JOBS);
+
+    for (int i = 0; i < numVoices; i++) {
+        jobs[i] = voices[i];
+    }
+
+    jobSlices = slices;
+    jobSamples = numSamples;
+    jobsDone.store(0, std::memory_order_relaxed);
+
+    // publishing the word also publishes the jobs written above
+    work.store(pack(++generation, numVoices, 0), std::memory_order_seq_cst);
+
+    for (auto* worker : workers) {
+        worker->wake();
+    }
+
+    while (claimAndRender()) {}
+
+    // The remaining jobs are already being rendered by the workers, a job can't be
+    // taken back halfway through. Spin briefly, then give the core away on every check
+    // in case a worker shares it.
+    for (int spins = 0; jobsDone.load(std::memory_order_acquire) < numVoices; spins++) {
+        if (spins < SPINS_BEFORE_YIELD)
+            pauseHint();
+        else
+            juce::Thread::yield();
+    }
+}
+
+bool VoiceRenderPool::claimAndRender() noexcept
+{
+    auto current = work.load(std::memory_order_acquire);
+
+    for (;;) {
+        const int count = (int)((current >> 16) & 0xffff);
+        const int next = (int)(current & 0xffff);
+
+        if (next >= count)
+            return false;
+
+        // the word only matches if nobody else took this job and no new block was published
+        if (work.compare_exchange_weak(current, current + 1, std::memory_order_acq_rel, std::memory_order_acquire)) {
+            jobs[next]->renderVoice(jobSamples, jobSlices[next]);
+            jobsDone.fetch_add(1, std::memory_order_release);
+            return true;
+        }
+    }
+}
+
+bool VoiceRenderPool::hasWork() const noexcept
+{
+    auto current = work.load(std::memory_order_seq_cst);
+    return (current & 0xffff) < ((current >> 16) & 0xffff);
+}
+
+//==============================================================================
+VoiceRenderPool::Worker::Worker(VoiceRenderPool& owner, int index)
+    : juce::Thread("Syrberus voice " + juce::String(index)), pool(owner)
+{
+}
+
+void VoiceRenderPool::Worker::wake() noexcept
+{
+    // only sleeping workers need the event, the spinning ones will see the work anyway
+    if (sleeping.load(std::memory_order_seq_cst))
+        wakeEvent.signal();
+}
+
+void VoiceRenderPool::Worker::run()
+{
+    // the same float mode as the audio thread, so a voice renders identically (and as fast) on either
+    juce::ScopedNoDenormals noDenormals;
+    int idleSpins = 0;
+
+    while (!threadShouldExit()) {
+        if (pool.claimAndRender()) {
+            idleSpins = 0;
+            continue;
+        }
+
+        if (++idleSpins < SPINS_BEFORE_SLEEP) {
+            juce::Thread::yield();
+            continue;
+        }
+
+        sleeping.store(true, std::memory_order_seq_cst);
+
+        // a block published before we went to sleep would not signal us
+        const bool woken = pool.hasWork() || wakeEvent.wait(100);
+
+        sleeping.store(false, std::memory_order_seq_cst);
+
+        // a timed out wait only checks for work once and goes back to sleep, spinning
+        // again is for when blocks are actually coming in
+        if (woken) idleSpins = 0;
+    }
+}
@@ -0,0 +1,77 @@
+/*
+  ==============================================================================
+
+    VoiceRenderPool.h
+    Created: 17 Oct 2026 8:21:54pm
+    Author:  Norb
+
+  ==============================================================================
+*/
+
+#pragma once
+#include <JuceHeader.h>
+
+class SyrberusVoice;
+struct VoiceScratch;
+
+/*
+ * A fixed set of worker threads that render voices in parallel.
+ *
+ * The audio thread publishes a block of jobs as one atomic word (generation, job
+ * count, next job) and then helps out. Whoever is free claims the next job with a
+ * compare-and-swap, so a worker that wakes up late simply finds nothing left to do
+ * and the audio thread never waits on a worker that has not started a job.
+*/
+class VoiceRenderPool {
+public:
+    enum { MAX_WORKERS = 8, MAX_JOBS = 64 };
+
+    // The audio thread's wait for the last jobs spins this long before it yields
+    enum { SPINS_BEFORE_YIELD = 256 };
+
+    ~VoiceRenderPool();
+
+    // Only starts workers the OS will schedule as realtime threads, possibly none
+    void start(int numWorkers);
+    void stop();
+    int getNumWorkers() const noexcept { return workers.size(); }
+
+    // Calls renderVoice on every voice, each with its own scratch slice, and returns
+    // once all of them are done
+    void render(SyrberusVoice* const* voices, const VoiceScratch* slices, int numVoices, int numSamples) noexcept;
+
+private:
+    class Worker : public juce::Thread {
+    public:
+        Worker(VoiceRenderPool& owner, int index);
+        void run() override;
+        void wake() noexcept;
+
+    private:
+        // Spinning keeps the next block's wake-up cheap, after that the worker sleeps
+        enum { SPINS_BEFORE_SLEEP = 4000 };
+
+        VoiceRenderPool& pool;
+        juce::WaitableEvent wakeEvent;
+        std::atomic<bool> sleeping { false };
+    };
+
+    bool claimAndRender() noexcept;
+    bool hasWork() const noexcept;
+
+    static juce::uint64 pack(juce::uint32 generation, int count, int next) noexcept
+    {
+        return ((juce::uint64)generation << 32) | ((juce::uint64)count << 16) | (juce::uint64)next;
+    }
+
+    juce::OwnedArray<Worker> workers;
+
+    // only written by the audio thread before a block is published
+    SyrberusVoice* jobs[MAX_JOBS];
+    const VoiceScratch* jobSlices = nullptr;
+    int jobSamples = 0;
+    juce::uint32 generation = 0;
+
+    std::atomic<juce::uint64> work { 0 };
+    std::atomic<int> jobsDone { 0 };
+};
@@ -0,0 +1,147 @@
+/*
+  ==============================================================================
+
+    WaveKernels.h
+    Created: 17 Oct 2026 2:47:05pm
+    Author:  Norb
+
+  ==============================================================================
+*/
+
+#pragma once
+#include <JuceHeader.h>
+
+/*
+ * Branch-free wave shapes that work on a single float or on a whole SIMD register
+ * of unison lanes at once. Phases are normalised, 0 being the start of the cycle.
+ *
+ * `Lanes` is the widest register juce::dsp::SIMDRegister gives us for this build
+ * (4 floats with SSE2/NEON, 8 with AVX2), or a plain float when SIMD is disabled.
+*/
+namespace WaveKernels {
+
+#if JUCE_USE_SIMD
+    using Lanes = juce::dsp::SIMDRegister<float>;
+    inline constexpr int laneWidth = (int)Lanes::SIMDNumElements;
+#else
+    using Lanes = float;
+    inline constexpr int laneWidth = 1;
+#endif
+
+    //==============================================================================
+    // scalar primitives
+    inline float splat(float value, float) noexcept                     { return value; }
+    inline float load(const float* source, float) noexcept             { return *source; }
+    inline void store(float* destination, float value) noexcept        { *destination = value; }
+    inline float sum(float value) noexcept                              { return value; }
+    inline float absolute(float value) noexcept                         { return std::abs(value); }
+    inline float fraction(float value) noexcept                         { return value - std::floor(value); }
+
+    // x < threshold ? below : above
+    inline float selectBelow(float x, float threshold, float below, float above) noexcept
+    {
+        return x < threshold ? below : above;
+    }
+
+#if JUCE_USE_SIMD
+    //==============================================================================
+    // vector primitives, the second argument of splat/load only picks the overload
+    inline Lanes splat(float value, Lanes) noexcept                     { return Lanes::expand(value); }
+    inline Lanes load(const float* source, Lanes) noexcept              { return Lanes::fromRawArray(source); }
+    inline void store(float* destination, Lanes value) noexcept         { value.copyToRawArray(destination); }
+    inline float sum(Lanes value) noexcept                              { return value.sum(); }
+    inline Lanes absolute(Lanes value) noexcept                         { return Lanes::abs(value); }
+
+    // only used on positive phases, so truncating is the same as flooring
+    inline Lanes fraction(Lanes value) noexcept                         { return value - Lanes::truncate(value); }
+
+    inline Lanes selectBelow(Lanes x, Lanes threshold, Lanes below, Lanes above) noexcept
+    {
+        auto mask = Lanes::lessThan(x, threshold);
+        return (below & mask) + (above & ~mask);
+    }
+
+    inline Lanes selectBelow(Lanes x, float threshold, Lanes below, Lanes above) noexcept
+    {
+        return selectBelow(x, Lanes::expand(threshold), below, above);
+    }
+#endif
+
+    //==============================================================================
+    // sin(2 * pi * p), parabolic approximation with one refinement step (~0.001 error),
+    // about as close as the old 128 point lookup table
+    template <typename T>
+    inline T sine(T p) noexcept
+    {
+        T q = p - splat(0.5f, p);
+        T y = q * (splat(8.0f, p) - splat(16.0f, p) * absolute(q));
+        y = splat(0.225f, p) * (y * absolute(y) - y) + y;
+        return splat(0.0f, p) - y; // sin(2 * pi * (q + 0.5)) = -sin(2 * pi * q)
+    }
+
+    template <typename T>
+    inline T square(T p) noexcept
+    {
+        return selectBelow(p, 0.5f, splat(1.0f, p), splat(-1.0f, p));
+    }
+
+    // rises to 1 at a quarter, falls to -1 at three quarters
+    template <typename T>
+    inline T triangle(T p) noexcept
+    {
+        return absolute(absolute(splat(4.0f, p) * p - splat(1.0f, p)) - splat(2.0f, p)) - splat(1.0f, p);
+    }
+
+    // rises from 0 to 1 over the first half, jumps to -1 and rises back to 0
+    template <typename T>
+    inline T saw(T p) noexcept
+    {
+        return splat(2.0f, p) * p - selectBelow(p, 0.5f, splat(0.0f, p), splat(2.0f, p));
+    }
+
+    // half a sine, then held at -1
+    template <typename T>
+    inline T sineSquare(T p) noexcept
+    {
+        return selectBelow(p, 0.5f, sine(p), splat(-1.0f, p));
+    }
+
+    //==============================================================================
+    // PolyBLEP residual for an upward jump of 2 at phase 0, `dt` being the phase increment
+    // (at most 0.5) and `invDt` its reciprocal. Zero everywhere but one sample either side.
+    template <typename T>
+    inline T polyBlep(T t, T dt, T invDt) noexcept
+    {
+        T zero = splat(0.0f, t);
+        T one = splat(1.0f, t);
+
+        T after = one - t * invDt;              // just past the edge
+        T before = (t - one) * invDt + one;     // just before it
+
+        return selectBelow(t, dt, zero - after * after, zero)
+             + selectBelow(one - dt, t, before * before, zero);
+    }
+
+    template <typename T>
+    inline T squareBandLimited(T p, T dt, T invDt) noexcept
+    {
+        T half = fraction(p + splat(0.5f, p));
+        return square(p) + polyBlep(p, dt, invDt) - polyBlep(half, dt, invDt);
+    }
+
+    template <typename T>
+    inline T sawBandLimited(T p, T dt, T invDt) noexcept
+    {
+        // the only jump is half way through the cycle
+        T half = fraction(p + splat(0.5f, p));
+        return saw(p) - polyBlep(half, dt, invDt);
+    }
+
+    template <typename T>
+    inline T sineSquareBandLimited(T p, T dt, T invDt) noexcept
+    {
+        // drops from 0 to -1 half way through, comes back up at the end of the cycle
+        T half = fraction(p + splat(0.5f, p));
+        return sineSquare(p) + splat(0.5f, p) * (polyBlep(p, dt, invDt) - polyBlep(half, dt, invDt));
+    }
+}
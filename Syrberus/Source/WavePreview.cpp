@@ -11,62 +11,214 @@
 #include "WavePreview.h"
 #include <cmath>  // For the pow function
 #include "Parameters.h"
+#include "UnisonBank.h"
+#include "WaveKernels.h"
 
-void WavePreview::update() {
-    repaint();
+namespace {
+    // the shapes the oscillators play, `cycles` being how far into the wave x is
+    float getWave(int shapeId, bool invert, float cycles) {
+        const float p = WaveKernels::fraction(cycles);
+        float result = 0.0f;
+        if (shapeId == UnisonBank::SINE) result = WaveKernels::sine(p);
+        if (shapeId == UnisonBank::SQUARE) result = WaveKernels::square(p);
+        if (shapeId == UnisonBank::TRIANGLE) result = WaveKernels::triangle(p);
+        if (shapeId == UnisonBank::SAW) result = WaveKernels::saw(p);
+        if (shapeId == UnisonBank::SINE_SQUARE) result = WaveKernels::sineSquare(p);
+        return result * (invert ? -1.0f : 1.0f);
+    }
 }
 
-float getSineWave(float x, float freq, float lengthUnit) {
-    // x 0 ~ 4
-    float frequency = 2.0f * juce::MathConstants<float>::pi / lengthUnit * freq;
-    return std::sin(frequency * x);
+WavePreview::~WavePreview()
+{
+    if (scope != nullptr)
+        scope->setEnabled(false);
+
+    if (apvts != nullptr)
+        forEachWatchedParameter([this](const juce::String& id) { apvts->removeParameterListener(id, this); });
 }
 
-float getSquareWave(float x, float freq, float lengthUnit) {
-    float frequency = 2.0f * juce::MathConstants<float>::pi / lengthUnit * freq;
-    return std::sin(frequency * x) >= 0 ? 1.0f : -1.0f;
+void WavePreview::attachApvts(juce::AudioProcessorValueTreeState* apvts)
+{
+    this->apvts = apvts;
+
+    // resolved once, redrawing never looks a parameter up by name
+    for (int i = 0; i < 3; i++) {
+        int id = i + 1;
+        osc[i] = OscillatorValues {
+            apvts->getRawParameterValue(Params::oscShape(id)),
+            apvts->getRawParameterValue(Params::oscMix(id)),
+            apvts->getRawParameterValue(Params::oscTranspose(id)),
+            apvts->getRawParameterValue(Params::oscPhase(id)),
+            apvts->getRawParameterValue(Params::oscInvert(id))
+        };
+    }
+    gain = apvts->getRawParameterValue(Params::miscGain);
+
+    forEachWatchedParameter([this](const juce::String& id) { this->apvts->addParameterListener(id, this); });
+
+    dirty = true;
+    startTimerHz(30);
+}
+
+void WavePreview::attachScope(ScopeBuffer* scopeToShow)
+{
+    scope = scopeToShow;
+}
+
+void WavePreview::mouseDown(const juce::MouseEvent&)
+{
+    if (scope == nullptr) return;
+
+    // the audio thread only feeds the scope while it is on screen
+    showScope = !showScope;
+    scope->setEnabled(showScope);
+    dirty = true;
 }
 
-float getTriangleWave(float x, float freq, float lengthUnit) {
-    float frequency = lengthUnit / freq;
-    float quarter = frequency * 0.25f;
-    float t = fmod(x, frequency);
-    if (t < quarter) return t / quarter;
-    if (t < quarter*3) return 1.0f - ((t - quarter) / (quarter * 2)) * 2.0f;
-    return (t - quarter*3) / quarter - 1.0f;
+void WavePreview::forEachWatchedParameter(std::function<void(const juce::String&)> callback) const
+{
+    for (int id = 1; id <= 3; id++) {
+        callback(Params::oscShape(id));
+        callback(Params::oscMix(id));
+        callback(Params::oscTranspose(id));
+        callback(Params::oscPhase(id));
+        callback(Params::oscInvert(id));
+    }
+    callback(Params::miscGain);
 }
 
-float getSawWave(float x, float freq, float lengthUnit) {
-    float frequency = lengthUnit / freq;
-    float half = frequency * 0.5f;
-    float t = fmod(x, frequency);
-    if (t < half) return (t / half);
-    return ((t - half) / half) - 1.0f;
+void WavePreview::parameterChanged(const juce::String&, float)
+{
+    // can be the audio thread, the redraw waits for the timer
+    dirty = true;
 }
 
-float getSineSquareWave(float x, float freq, float lengthUnit) {
-    float frequency = lengthUnit / freq;
-    float half = frequency * 0.5f;
-    float t = fmod(x, frequency);
-    if (t < half) return getSineWave(x, freq, lengthUnit);
-    return getSquareWave(x, freq, lengthUnit);
+void WavePreview::timerCallback()
+{
+    // the scope changes every frame, the shape only when its parameters do
+    if (!dirty.exchange(false) && !showScope)
+        return;
+
+    if (apvts == nullptr)
+        return;
+
+    if (showScope)
+        updateScope();
+    else
+        updateWaveform();
+
+    renderCache();
+    repaint();
 }
 
-float getWave(int shapeId, bool invert, float x, float freq, float lengthUnit) {
-    float result = 0.0f;
-    if (shapeId == 0) result = getSineWave(x, freq, lengthUnit);
-    if (shapeId == 1) result = getSquareWave(x, freq, lengthUnit);
-    if (shapeId == 2) result = getTriangleWave(x, freq, lengthUnit);
-    if (shapeId == 3) result = getSawWave(x, freq, lengthUnit);
-    if (shapeId == 4) result = getSineSquareWave(x, freq, lengthUnit);
-    return result * (invert ? -1.0f : 1.0f);
+void WavePreview::resized()
+{
+    dirty = true;
+}
+
+void WavePreview::updateWaveform()
+{
+    const int width = getWidth();
+    const float oneLengthUnit = width / 4.0f;
+    waveform.assign((size_t)juce::jmax(0, width), 0.0f);
+
+    float shape[3], weight[3], freq[3], phase[3]; bool invert[3];
+    for (int i = 0; i < 3; i++) {
+        shape[i] = std::round(osc[i].shape->load());
+        weight[i] = osc[i].mix->load();
+        phase[i] = osc[i].phase->load();
+        invert[i] = osc[i].invert->load() > 0.5f;
+
+        // frequency ratio equation:
+        // 2^(transpose/12)
+        freq[i] = powf(2.0f, std::round(osc[i].transpose->load()) / 12.0f);
+    }
+    float totalWeight = weight[0] + weight[1] + weight[2];
+    if (totalWeight < 1.0f) totalWeight = 1.0f; // min total weight of 1 to allow shaping of single osc
+
+    for (int x = 0; x < width; x++) {
+        float mixed = 0.0f;
+        for (int i = 0; i < 3; i++) {
+            if (weight[i] == 0.0f) continue;
+
+            float px = x + oneLengthUnit * phase[i];
+            mixed += getWave((int)shape[i], invert[i], px * freq[i] / oneLengthUnit) * weight[i];
+        }
+        waveform[(size_t)x] = mixed / totalWeight;
+    }
+}
+
+void WavePreview::updateScope()
+{
+    const int width = getWidth();
+    const int window = juce::jlimit(1, ScopeBuffer::CAPACITY / 4, (int)(scope->getSampleRate() * SCOPE_SECONDS));
+
+    // everything the ring keeps, the trigger needs room to look back for a crossing
+    scopeSamples.resize((size_t)(ScopeBuffer::CAPACITY / 2));
+    const int total = (int)scopeSamples.size();
+    const int valid = scope->readLatest(scopeSamples.data(), total);
+    const int oldest = total - valid;
+
+    // anything the audio thread overwrote while it was being copied is blanked out
+    std::fill(scopeSamples.begin(), scopeSamples.begin() + oldest, 0.0f);
+
+    // lock onto the latest rising zero crossing that still leaves a whole window after it,
+    // so a steady note stands still instead of scrolling
+    int start = total - window;
+    for (int i = total - window; i > oldest; i--) {
+        if (scopeSamples[(size_t)i - 1] < 0.0f && scopeSamples[(size_t)i] >= 0.0f) {
+            start = i;
+            break;
+        }
+    }
+
+    // decimated here rather than on the audio thread: the peak of each pixel column
+    // (whichever of its min and max is further from zero) so nothing narrower than a
+    // pixel disappears
+    waveform.assign((size_t)juce::jmax(0, width), 0.0f);
+    for (int x = 0; x < width; x++) {
+        const int from = start + (int)((juce::int64)window * x / width);
+        const int to = juce::jmax(from + 1, start + (int)((juce::int64)window * (x + 1) / width));
+
+        float low = scopeSamples[(size_t)from], high = low;
+        for (int i = from + 1; i < to; i++) {
+            low = juce::jmin(low, scopeSamples[(size_t)i]);
+            high = juce::jmax(high, scopeSamples[(size_t)i]);
+        }
+
+        waveform[(size_t)x] = std::abs(high) >= std::abs(low) ? high : low;
+    }
 }
 
 void WavePreview::paint(juce::Graphics& g)
 {
-    auto width = getBounds().getWidth();
+    g.drawImage(cache, getLocalBounds().toFloat());
+}
+
+void WavePreview::renderCache()
+{
+    auto width = getWidth();
+    auto height = getHeight();
+    if (width <= 0 || height <= 0) {
+        cache = {};
+        return;
+    }
+
+    // drawn at the display's scale, so it stays sharp on high DPI screens
+    const float scale = juce::Component::getApproximateScaleFactorForComponent(this);
+    const int imageWidth = juce::roundToInt(width * scale);
+    const int imageHeight = juce::roundToInt(height * scale);
+
+    // the scope redraws on every tick, the image is only reallocated when the size or scale changes
+    if (cache.isNull() || cache.getWidth() != imageWidth || cache.getHeight() != imageHeight)
+        cache = juce::Image(juce::Image::ARGB, imageWidth, imageHeight, true);
+    else
+        cache.clear(cache.getBounds());
+
+    juce::Graphics g(cache);
+    g.addTransform(juce::AffineTransform::scale(scale));
+
     auto oneLengthUnit = width / 4.0f;
-    auto height = getBounds().getHeight();
     auto centerY = height * 0.5f;
 
     g.setColour(juce::Colour::fromRGB(32, 28, 31));
@@ -81,59 +233,30 @@ void WavePreview::paint(juce::Graphics& g)
         g.drawVerticalLine(oneLengthUnit * i, 0, height);
     }
 
-    // extract all the values and try visualize it, we'll refactor this into its own class later and utilize actual Oscilators
-    float shape[3], weight[3], transpose[3], phase[3]; bool invert[3];
-    for (int i = 0; i < 3; i++) {
-        int id = i + 1;
-        shape[i] = static_cast<int>(std::round(apvts->getParameter(Params::oscShape(id))->getValue() * 4));
-        weight[i] = apvts->getParameter(Params::oscMix(id))->getValue();
-        transpose[i] = static_cast<int>(std::round(apvts->getParameter(Params::oscTranspose(id))->getValue() * 48)) - 24;
-        phase[i] = apvts->getParameter(Params::oscPhase(id))->getValue();
-        invert[i] = apvts->getParameter(Params::oscInvert(id))->getValue() > 0.5f;
-    }
-    float totalWeight = weight[0] + weight[1] + weight[2];
-    if (totalWeight < 1.0f) totalWeight = 1.0f; // min total weight of 1 to allow shaping of single osc
-    float miscGain = apvts->getParameter(Params::miscGain)->getValue();
-    
-    // In reality the oscilators will create the shape, but I want to
-    // develop a deeper understanding how waves behave mathematically.
-    // The shape produced in this preview will be compared with the
-    // actual shapes produced by the oscilators inside a DAW.
-
-    // Firstly, we have to establish that an octave (12 semitones)
+    // The shape is worked out from the same wave kernels the oscillators
+    // play, the scope shows what they actually produced.
+
+    // For the shape, we have to establish that an octave (12 semitones)
     // doubles/halves the wavelength. We split the preview into 4
     // horizontal slices. That's because we can go down to -24 semitones
     // on any oscillator, which is 4 times longer than the base 0.
-
-    // frequency ratio equation:
-    // 2^(transpose/12)
-    float freq1 = powf(2.0f, transpose[0] / 12.0f);
-    float freq2 = powf(2.0f, transpose[1] / 12.0f);
-    float freq3 = powf(2.0f, transpose[2] / 12.0f);
-
     juce::Path sinePath;
-    float amplitude = (height / 3) * (miscGain * 2.0f);
+
+    // the scope's samples already went through the gain
+    float amplitude = showScope ? (height / 3) * 2.0f : (height / 3) * (gain->load() * 2.0f);
 
     sinePath.startNewSubPath(0, height / 2); // Start in the middle
-    for (float x = 0; x < width; x++)
+    for (int x = 0; x < (int)waveform.size(); x++)
     {
-        float px1 = x + oneLengthUnit * phase[0];
-        float px2 = x + oneLengthUnit * phase[1];
-        float px3 = x + oneLengthUnit * phase[2];
-        float wave1 = getWave(shape[0], invert[0], px1, freq1, oneLengthUnit) * weight[0];
-        float wave2 = getWave(shape[1], invert[1], px2, freq2, oneLengthUnit) * weight[1];
-        float wave3 = getWave(shape[2], invert[2], px3, freq3, oneLengthUnit) * weight[2];
-
-        float y = centerY - amplitude * ((wave1 + wave2 + wave3) / totalWeight);
-        //float y = height / 2 - amplitude * getSineSquareWave(x, freq1, oneLengthUnit);
-        sinePath.lineTo(x, y);
+        sinePath.lineTo((float)x, centerY - amplitude * waveform[(size_t)x]);
     }
 
     g.setColour(juce::Colour::fromRGB(253, 97, 254));
     g.strokePath(sinePath, juce::PathStrokeType(2.0f)); // Draw the path
-}
 
-void WavePreview::attachApvts(juce::AudioProcessorValueTreeState* apvts)
-{
-    this->apvts = apvts;
-}
\ No newline at end of file
+    if (scope != nullptr) {
+        g.setColour(juce::Colours::white.withAlpha(0.3f));
+        g.setFont(11.0f);
+        g.drawText(showScope ? "SCOPE" : "SHAPE", 0, 4, width - 8, 14, juce::Justification::topRight);
+    }
+}
@@ -11,16 +11,62 @@
 #pragma once
 
 #include <JuceHeader.h>
+#include "ScopeBuffer.h"
 
-class WavePreview : public juce::AnimatedAppComponent
+/*
+ * Draws one cycle of the mixed oscillators, or with a click, an oscilloscope of
+ * what the plugin is actually playing.
+ *
+ * The drawing is cached in an image and only rebuilt when one of the parameters
+ * it shows changes, the rest of the time paint just copies the image. Parameter
+ * changes can arrive on any thread, so the listener only raises a flag and the
+ * timer does the work on the message thread.
+*/
+class WavePreview : public juce::Component,
+                    private juce::AudioProcessorValueTreeState::Listener,
+                    private juce::Timer
 {
 
 public:
-    void update() override;
+    ~WavePreview() override;
+
     void paint(juce::Graphics& g) override;
+    void resized() override;
+    void mouseDown(const juce::MouseEvent&) override;
     void attachApvts(juce::AudioProcessorValueTreeState* apvts);
+    void attachScope(ScopeBuffer* scopeToShow);
 
 private:
-    juce::AudioProcessorValueTreeState* apvts;
+    struct OscillatorValues {
+        std::atomic<float>* shape;
+        std::atomic<float>* mix;
+        std::atomic<float>* transpose;
+        std::atomic<float>* phase;
+        std::atomic<float>* invert;
+    };
+
+    void parameterChanged(const juce::String& parameterID, float newValue) override;
+    void timerCallback() override;
+
+    void forEachWatchedParameter(std::function<void(const juce::String&)> callback) const;
+    void updateWaveform();
+    void updateScope();
+    void renderCache();
+
+    juce::AudioProcessorValueTreeState* apvts = nullptr;
+    OscillatorValues osc[3] {};
+    std::atomic<float>* gain = nullptr;
+
+    // how much of the output the scope shows at once
+    static constexpr double SCOPE_SECONDS = 0.025;
+
+    // one sample per pixel column, for the shape -1 to 1 before the gain
+    std::vector<float> waveform;
+
+    ScopeBuffer* scope = nullptr;
+    std::vector<float> scopeSamples;
+    bool showScope = false;
+    juce::Image cache;
 
-};
\ No newline at end of file
+    std::atomic<bool> dirty { true };
+};
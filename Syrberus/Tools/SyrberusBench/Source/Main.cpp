@@ -0,0 +1,345 @@
+/*
+  ==============================================================================
+
+    Main.cpp
+    Created: 17 Oct 2026 10:02:51pm
+    Author:  Norb
+
+    Micro-benchmarks for the engine's hot paths, each one run at every block
+    size from 16 to 2048 unless the block size makes no difference to it.
+    Results are printed as a table and can be written as JSON in the same
+    layout as Google Benchmark, so its compare.py can diff two runs.
+
+  ==============================================================================
+*/
+
+#include <JuceHeader.h>
+#include "../../../Source/PluginProcessor.h"
+#include "../../../Source/ParameterCache.h"
+#include "../../../Source/UnisonBank.h"
+#include "../../../Source/SyrberusOscillator.h"
+#include "../../../Source/Envelope.h"
+
+namespace {
+    constexpr double SAMPLE_RATE = 48000.0;
+    const int BLOCK_SIZES[] = { 16, 32, 64, 128, 256, 512, 1024, 2048 };
+
+    // Builds everything a case needs for one block size and returns the work for a single iteration
+    using Iteration = std::function<void()>;
+    using Fixture = std::function<Iteration(int blockSize)>;
+
+    struct Case {
+        juce::String name;
+        Fixture fixture;
+        bool perBlockSize = true;   // otherwise run once, an iteration is one call rather than one block
+    };
+
+    struct Result {
+        juce::String name;
+        int blockSize;
+        juce::int64 iterations;
+        double nanosPerBlock;
+    };
+
+    // keeps the optimiser from throwing rendered samples away
+    volatile float sink = 0.0f;
+
+    // A stereo block plus one gain per sample, all the voice render paths take
+    struct VoiceBuffers {
+        explicit VoiceBuffers(int blockSize)
+            : left((size_t)blockSize), right((size_t)blockSize), gains((size_t)blockSize, 1.0f) {}
+
+        std::vector<float> left, right, gains;
+    };
+
+    juce::dsp::ProcessSpec makeSpec(int blockSize)
+    {
+        return { SAMPLE_RATE, (juce::uint32)blockSize, 2 };
+    }
+
+    UnisonBank::SyrberusOscillatorParams makeOscillatorParams(UnisonBank::WaveType type, bool allOscillators)
+    {
+        UnisonBank::SyrberusOscillatorParams params {};
+
+        for (int o = 0; o < UnisonBank::NUM_OSCILLATORS; o++) {
+            float gain = (o == 0 || allOscillators) ? 1.0f : 0.0f;
+            params.osc[o] = UnisonBank::OscillatorParams { type, o * 7, gain, 0.0f, 0.5f, false };
+        }
+
+        params.antiAliasing = true;
+        return params;
+    }
+
+    // One oscillator of the given shape, one unison layer: the cost of a single layer
+    Fixture unisonBankCase(UnisonBank::WaveType type)
+    {
+        return [type](int blockSize) -> Iteration {
+            auto bank = std::make_shared<UnisonBank>();
+            auto buffers = std::make_shared<VoiceBuffers>(blockSize);
+
+            bank->prepare(makeSpec(blockSize));
+            bank->updateParams(makeOscillatorParams(type, false));
+            bank->setUnison(1, 0.0f);
+            bank->setKey(60);
+            bank->reset();
+
+            return [bank, buffers, blockSize]() {
+                bank->process(buffers->left.data(), buffers->right.data(), buffers->gains.data(), blockSize);
+                sink = buffers->left[0];
+            };
+        };
+    }
+
+    // All three oscillators (sine, saw, square) at the given unison
+    Fixture oscillatorCase(int unison)
+    {
+        return [unison](int blockSize) -> Iteration {
+            auto oscillator = std::make_shared<SyrberusOscillator>();
+            auto buffers = std::make_shared<VoiceBuffers>(blockSize);
+
+            auto params = makeOscillatorParams(UnisonBank::SINE, true);
+            params.osc[1].type = UnisonBank::SAW;
+            params.osc[2].type = UnisonBank::SQUARE;
+
+            oscillator->prepare(makeSpec(blockSize));
+            oscillator->updateParams(params);
+            oscillator->setUnison(unison, 0.2f);
+            oscillator->setKey(60);
+            oscillator->reset();
+
+            return [oscillator, buffers, blockSize]() {
+                oscillator->process(buffers->left.data(), buffers->right.data(), buffers->gains.data(), blockSize);
+                sink = buffers->left[0];
+            };
+        };
+    }
+
+    // sustaining is a different loop from the segments, so both are measured
+    Fixture envelopeCase(bool sustaining)
+    {
+        return [sustaining](int blockSize) -> Iteration {
+            auto graph = std::make_shared<dubu::EnvelopeGraph>();
+            auto envelope = std::make_shared<dubu::Envelope>();
+            auto buffers = std::make_shared<VoiceBuffers>(blockSize);
+
+            // a plucky ADSR, the note released as soon as the decay is done so the
+            // segment case keeps cycling through attack, decay and release
+            const float attack = 0.01f, decay = 0.2f;
+            graph->setParams(0.0f, sustaining ? 0.0f : attack, 0.0f, sustaining ? 0.0f : decay, 0.7f, 0.1f);
+
+            envelope->setGraph(graph.get());
+            envelope->prepare(SAMPLE_RATE);
+            envelope->noteOn();
+
+            struct Note {
+                int held = 0;
+                bool released = false;
+            };
+
+            const int noteLength = (int)((attack + decay) * SAMPLE_RATE);
+            auto note = std::make_shared<Note>();
+
+            return [graph, envelope, buffers, blockSize, sustaining, noteLength, note]() {
+                if (!sustaining) {
+                    if (!envelope->isActive()) {
+                        envelope->noteOn();
+                        *note = {};
+                    }
+                    else if (!note->released && note->held >= noteLength) {
+                        envelope->noteOff();
+                        note->released = true;
+                    }
+
+                    note->held += blockSize;
+                }
+
+                envelope->getNextGains(buffers->gains.data(), blockSize);
+                sink = buffers->gains[0];
+            };
+        };
+    }
+
+    // Taking the per-block parameter snapshot, which replaced building SyrberusOscillatorParams
+    Fixture parameterCacheCase()
+    {
+        return [](int) -> Iteration {
+            auto processor = std::make_shared<SyrberusAudioProcessor>();
+            auto cache = std::make_shared<ParameterCache>(processor->apvts);
+
+            return [processor, cache]() {
+                sink = cache->update().gain;
+            };
+        };
+    }
+
+    Fixture limiterCase()
+    {
+        return [](int blockSize) -> Iteration {
+            auto limiter = std::make_shared<juce::dsp::Limiter<float>>();
+            auto buffer = std::make_shared<juce::AudioBuffer<float>>(2, blockSize);
+
+            limiter->prepare(makeSpec(blockSize));
+            limiter->setThreshold(3.0f);
+            limiter->setRelease(10.0f);
+
+            // loud enough that the limiter actually works
+            juce::Random random(1);
+            for (int channel = 0; channel < 2; channel++) {
+                for (int i = 0; i < blockSize; i++) {
+                    buffer->setSample(channel, i, 4.0f * (random.nextFloat() - 0.5f));
+                }
+            }
+
+            return [limiter, buffer]() {
+                juce::dsp::AudioBlock<float> block(*buffer);
+                limiter->process(juce::dsp::ProcessContextReplacing<float>(block));
+                sink = buffer->getSample(0, 0);
+            };
+        };
+    }
+
+    std::vector<Case> makeCases()
+    {
+        return {
+            { "UnisonBank/Sine",        unisonBankCase(UnisonBank::SINE) },
+            { "UnisonBank/Square",      unisonBankCase(UnisonBank::SQUARE) },
+            { "UnisonBank/Triangle",    unisonBankCase(UnisonBank::TRIANGLE) },
+            { "UnisonBank/Saw",         unisonBankCase(UnisonBank::SAW) },
+            { "UnisonBank/SineSquare",  unisonBankCase(UnisonBank::SINE_SQUARE) },
+            { "SyrberusOscillator/Unison1",  oscillatorCase(1) },
+            { "SyrberusOscillator/Unison8",  oscillatorCase(8) },
+            { "SyrberusOscillator/Unison17", oscillatorCase(17) },
+            { "Envelope/Segment",       envelopeCase(false) },
+            { "Envelope/Sustain",       envelopeCase(true) },
+            { "ParameterCache/Update",  parameterCacheCase(), false },
+            { "Limiter/Stereo",         limiterCase() }
+        };
+    }
+
+    // Runs batches of iterations until minSeconds have been spent timing
+    Result runCase(const Case& benchmark, int blockSize, double minSeconds)
+    {
+        auto iteration = benchmark.fixture(blockSize);
+
+        // warm the caches and let the smoothed values settle
+        for (int i = 0; i < 64; i++) iteration();
+
+        juce::int64 iterations = 0;
+        juce::int64 ticks = 0;
+        juce::int64 batch = 16;
+
+        while (juce::Time::highResolutionTicksToSeconds(ticks) < minSeconds) {
+            const auto start = juce::Time::getHighResolutionTicks();
+            for (juce::int64 i = 0; i < batch; i++) iteration();
+            ticks += juce::Time::getHighResolutionTicks() - start;
+
+            iterations += batch;
+            batch = juce::jmin(batch * 2, (juce::int64)1 << 20);
+        }
+
+        const double nanos = juce::Time::highResolutionTicksToSeconds(ticks) * 1.0e9 / (double)iterations;
+        const auto name = benchmark.perBlockSize ? benchmark.name + "/" + juce::String(blockSize) : benchmark.name;
+        return { name, blockSize, iterations, nanos };
+    }
+
+    juce::var toJson(const std::vector<Result>& results)
+    {
+        auto context = std::make_unique<juce::DynamicObject>();
+        context->setProperty("date", juce::Time::getCurrentTime().toISO8601(true));
+        context->setProperty("host_name", juce::SystemStats::getComputerName());
+        context->setProperty("num_cpus", juce::SystemStats::getNumCpus());
+        context->setProperty("mhz_per_cpu", juce::SystemStats::getCpuSpeedInMegahertz());
+        context->setProperty("sample_rate", SAMPLE_RATE);
+       #if JUCE_DEBUG
+        context->setProperty("library_build_type", "debug");
+       #else
+        context->setProperty("library_build_type", "release");
+       #endif
+
+        juce::Array<juce::var> benchmarks;
+        for (auto& result : results) {
+            auto entry = std::make_unique<juce::DynamicObject>();
+            entry->setProperty("name", result.name);
+            entry->setProperty("run_type", "iteration");
+            entry->setProperty("iterations", result.iterations);
+            entry->setProperty("real_time", result.nanosPerBlock);
+            entry->setProperty("cpu_time", result.nanosPerBlock);
+            entry->setProperty("time_unit", "ns");
+            entry->setProperty("items_per_second", result.blockSize * 1.0e9 / result.nanosPerBlock);
+            benchmarks.add(juce::var(entry.release()));
+        }
+
+        auto root = std::make_unique<juce::DynamicObject>();
+        root->setProperty("context", juce::var(context.release()));
+        root->setProperty("benchmarks", benchmarks);
+        return juce::var(root.release());
+    }
+
+    void printUsage()
+    {
+        std::cout << "SyrberusBench - times the engine's hot paths at block sizes 16 to 2048\n\n"
+                     "  --filter <text>         only runs cases whose name contains the text\n"
+                     "  --min-time <seconds>    time spent on each case and block size (default 0.2)\n"
+                     "  --json <file>           also writes the results as JSON\n"
+                     "  --list                  lists the cases and exits\n";
+    }
+}
+
+int main(int argc, char* argv[])
+{
+    // the parameter tree runs a timer, which needs a message manager
+    juce::ScopedJuceInitialiser_GUI juceInitialiser;
+
+    juce::String filter;
+    juce::File jsonFile;
+    double minSeconds = 0.2;
+    bool listOnly = false;
+
+    for (int i = 1; i < argc; i++) {
+        const juce::String arg(argv[i]);
+        const bool hasValue = i + 1 < argc;
+
+        if (arg == "--list")                        listOnly = true;
+        else if (arg == "--filter" && hasValue)     filter = argv[++i];
+        else if (arg == "--min-time" && hasValue)   minSeconds = juce::String(argv[++i]).getDoubleValue();
+        else if (arg == "--json" && hasValue)       jsonFile = juce::File::getCurrentWorkingDirectory().getChildFile(argv[++i]);
+        else {
+            printUsage();
+            return 1;
+        }
+    }
+
+    juce::ScopedNoDenormals noDenormals;
+    std::vector<Result> results;
+
+    for (auto& benchmark : makeCases()) {
+        if (filter.isNotEmpty() && !benchmark.name.containsIgnoreCase(filter))
+            continue;
+
+        if (listOnly) {
+            std::cout << benchmark.name << "\n";
+            continue;
+        }
+
+        // a case that ignores the block size runs once, timed per call
+        const auto blockSizes = benchmark.perBlockSize ? std::vector<int>(std::begin(BLOCK_SIZES), std::end(BLOCK_SIZES))
+                                                       : std::vector<int> { 1 };
+
+        for (int blockSize : blockSizes) {
+            auto result = runCase(benchmark, blockSize, minSeconds);
+            results.push_back(result);
+
+            std::cout << result.name.paddedRight(' ', 36)
+                      << juce::String(result.nanosPerBlock, 1).paddedLeft(' ', 14) << " ns/block"
+                      << juce::String(result.nanosPerBlock / blockSize, 2).paddedLeft(' ', 10) << " ns/sample"
+                      << juce::String(result.iterations).paddedLeft(' ', 12) << " iterations\n";
+        }
+    }
+
+    if (jsonFile != juce::File() && !jsonFile.replaceWithText(juce::JSON::toString(toJson(results)))) {
+        std::cerr << "Could not write " << jsonFile.getFullPathName() << "\n";
+        return 1;
+    }
+
+    return 0;
+}
@@ -0,0 +1,147 @@
+/*
+  ==============================================================================
+
+    Main.cpp
+    Created: 18 Oct 2026 3:40:18am
+    Author:  Norb
+
+    Builds the preset library the plugin lists as its programs from a folder
+    of preset files, and lists what is in a library.
+
+  ==============================================================================
+*/
+
+#include <JuceHeader.h>
+#include "../../../Source/PluginProcessor.h"
+
+namespace {
+    void printUsage()
+    {
+        std::cout << "SyrberusPresets - builds and inspects preset libraries\n\n"
+                     "  --pack <folder> --out <file.syrlib>   packs every preset under the folder, each\n"
+                     "                                        tagged with the subfolders it is in\n"
+                     "  --list <file.syrlib>                  lists the presets in a library and their tags\n";
+    }
+
+    // Hand-written presets are plain XML, saved ones are the binary chunk from getStateInformation
+    bool loadPreset(SyrberusAudioProcessor& processor, const juce::File& file)
+    {
+        juce::MemoryBlock data;
+        if (!file.loadFileAsData(data)) return false;
+
+        if (auto xml = juce::parseXML(file)) {
+            data.reset();
+            juce::AudioProcessor::copyXmlToBinary(*xml, data);
+        }
+
+        processor.setStateInformation(data.getData(), (int)data.getSize());
+        return true;
+    }
+
+    int pack(const juce::File& folder, const juce::File& library)
+    {
+        // the processor turns every preset, whatever its format or version, into the current binary state
+        SyrberusAudioProcessor processor;
+        PresetLibrary::Builder builder;
+        int count = 0;
+
+        // a hand-written preset only lists some parameters, the rest should be defaults rather than the previous file's
+        juce::MemoryBlock defaults;
+        processor.getStateInformation(defaults);
+
+        // Hosts store program numbers in their sessions, so the library's order must not
+        // depend on the file system: presets go in sorted by their path in the folder
+        std::vector<std::pair<juce::String, juce::File>> files;
+        for (auto& entry : juce::RangedDirectoryIterator(folder, true, "*", juce::File::findFiles)) {
+            if (!entry.isHidden())
+                files.emplace_back(entry.getFile().getRelativePathFrom(folder).replaceCharacter('\\', '/'), entry.getFile());
+        }
+
+        std::sort(files.begin(), files.end(), [](const auto& a, const auto& b) { return a.first.compare(b.first) < 0; });
+
+        for (auto& [path, file] : files) {
+            processor.setStateInformation(defaults.getData(), (int)defaults.getSize());
+
+            if (!loadPreset(processor, file)) {
+                std::cerr << "Could not read preset " << file.getFullPathName() << "\n";
+                return 1;
+            }
+
+            juce::StringArray tags;
+            tags.addTokens(file.getParentDirectory().getRelativePathFrom(folder), "/\\", {});
+            tags.removeString(".");
+            tags.removeEmptyStrings();
+
+            juce::MemoryBlock state;
+            processor.getStateInformation(state);
+
+            const auto added = builder.add(file.getFileNameWithoutExtension(), tags, state);
+            if (added.failed()) {
+                std::cerr << path << ": " << added.getErrorMessage() << "\n";
+                return 1;
+            }
+
+            count++;
+        }
+
+        const auto result = builder.writeTo(library);
+        if (result.failed()) {
+            std::cerr << result.getErrorMessage() << "\n";
+            return 1;
+        }
+
+        std::cout << "Packed " << count << " presets into " << library.getFullPathName() << "\n";
+        return 0;
+    }
+
+    int list(const juce::File& file)
+    {
+        PresetLibrary library;
+        if (!library.open(file)) {
+            std::cerr << "Could not open preset library " << file.getFullPathName() << "\n";
+            return 1;
+        }
+
+        for (int i = 0; i < library.getNumPresets(); i++) {
+            std::cout << library.getName(i);
+
+            const auto tags = library.getTags(i);
+            if (!tags.isEmpty())
+                std::cout << "  [" << tags.joinIntoString(", ") << "]";
+
+            std::cout << "\n";
+        }
+
+        return 0;
+    }
+}
+
+int main(int argc, char* argv[])
+{
+    // the parameter tree runs a timer, which needs a message manager
+    juce::ScopedJuceInitialiser_GUI juceInitialiser;
+
+    juce::File folder, output, listed;
+
+    for (int i = 1; i + 1 < argc; i += 2) {
+        const juce::String arg(argv[i]);
+        const auto file = juce::File::getCurrentWorkingDirectory().getChildFile(juce::String(argv[i + 1]));
+
+        if (arg == "--pack")        folder = file;
+        else if (arg == "--out")    output = file;
+        else if (arg == "--list")   listed = file;
+        else {
+            printUsage();
+            return 1;
+        }
+    }
+
+    if (folder != juce::File() && output != juce::File())
+        return pack(folder, output);
+
+    if (listed != juce::File())
+        return list(listed);
+
+    printUsage();
+    return argc < 2 ? 0 : 1;
+}
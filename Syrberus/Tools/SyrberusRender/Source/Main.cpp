@@ -0,0 +1,353 @@
+/*
+  ==============================================================================
+
+    Main.cpp
+    Created: 17 Oct 2026 9:14:37pm
+    Author:  Norb
+
+    Renders the synth to a WAV file without a host and reports how long every
+    block took, so engine changes can be measured outside a DAW.
+
+  ==============================================================================
+*/
+
+#include <JuceHeader.h>
+#include <numeric>
+#include "../../../Source/PluginProcessor.h"
+
+namespace {
+    struct RenderSettings {
+        double sampleRate = 48000.0;
+        int blockSize = 512;
+        double tailSeconds = 2.0;
+        double patternSeconds = 10.0;
+        bool offline = false;
+
+        juce::File preset;
+        juce::File midiFile;
+        juce::File output;
+        juce::File dumpPreset;
+        juce::File library;
+        juce::String libraryPreset;
+        juce::String pattern = "chords";
+        juce::StringPairArray overrides; // parameter id -> value
+    };
+
+    struct RenderStats {
+        std::vector<double> blockSeconds;
+        double audioSeconds = 0.0;
+        juce::int64 voiceBlocks = 0; // sum of active voices over all blocks
+        int peakVoices = 0;
+    };
+
+    void printUsage()
+    {
+        std::cout << "SyrberusRender - renders the synth offline and times every block\n\n"
+                     "  --out <file.wav>        where to write the render (optional)\n"
+                     "  --preset <file>         plugin state, XML or the host's binary chunk\n"
+                     "  --dump-preset <file>    writes the state after --preset/--set as XML\n"
+                     "  --library <file>        preset library to play from\n"
+                     "  --library-preset <name> loads a preset from --library before --preset/--set\n"
+                     "  --midi <file.mid>       notes to play, overrides --pattern\n"
+                     "  --pattern <name>        chords, arp or stress (default chords)\n"
+                     "  --length <seconds>      length of the generated pattern (default 10)\n"
+                     "  --tail <seconds>        extra time rendered after the last event (default 2)\n"
+                     "  --rate <hz>             sample rate (default 48000)\n"
+                     "  --block <samples>       block size (default 512)\n"
+                     "  --set <ID>=<value>      sets a parameter, e.g. --set MISC_POLYPHONY=32\n"
+                     "  --offline               renders like a host bounce, with the offline quality settings\n"
+                     "  --help                  prints this, as does running without arguments\n";
+    }
+
+    bool parseArguments(int argc, char* argv[], RenderSettings& settings)
+    {
+        for (int i = 1; i < argc; i++) {
+            const juce::String arg(argv[i]);
+            const bool hasValue = i + 1 < argc;
+
+            auto value = [&]() { return juce::String(argv[++i]); };
+            auto file = [&]() { return juce::File::getCurrentWorkingDirectory().getChildFile(value()); };
+
+            if (arg == "--offline")                     settings.offline = true;
+            else if (!hasValue)                         return false;
+            else if (arg == "--out")                    settings.output = file();
+            else if (arg == "--preset")                 settings.preset = file();
+            else if (arg == "--dump-preset")            settings.dumpPreset = file();
+            else if (arg == "--library")                settings.library = file();
+            else if (arg == "--library-preset")         settings.libraryPreset = value();
+            else if (arg == "--midi")                   settings.midiFile = file();
+            else if (arg == "--pattern")                settings.pattern = value();
+            else if (arg == "--length")                 settings.patternSeconds = value().getDoubleValue();
+            else if (arg == "--tail")                   settings.tailSeconds = value().getDoubleValue();
+            else if (arg == "--rate")                   settings.sampleRate = value().getDoubleValue();
+            else if (arg == "--block")                  settings.blockSize = value().getIntValue();
+            else if (arg == "--set") {
+                auto assignment = value();
+                if (!assignment.contains("=")) return false;
+                settings.overrides.set(assignment.upToFirstOccurrenceOf("=", false, false),
+                                       assignment.fromFirstOccurrenceOf("=", false, false));
+            }
+            else return false;
+        }
+
+        return settings.sampleRate > 0.0 && settings.blockSize > 0;
+    }
+
+    bool loadPreset(SyrberusAudioProcessor& processor, const juce::File& file)
+    {
+        juce::MemoryBlock data;
+        if (!file.loadFileAsData(data)) return false;
+
+        // hand-written presets are plain XML, saved ones are the binary chunk from getStateInformation
+        if (auto xml = juce::parseXML(file)) {
+            data.reset();
+            juce::AudioProcessor::copyXmlToBinary(*xml, data);
+        }
+
+        processor.setStateInformation(data.getData(), (int)data.getSize());
+        return true;
+    }
+
+    bool applyOverrides(SyrberusAudioProcessor& processor, const juce::StringPairArray& overrides)
+    {
+        for (auto& id : overrides.getAllKeys()) {
+            auto* param = processor.apvts.getParameter(id);
+            if (param == nullptr) {
+                std::cerr << "Unknown parameter " << id << "\n";
+                return false;
+            }
+
+            param->setValueNotifyingHost(param->convertTo0to1(overrides[id].getFloatValue()));
+        }
+
+        return true;
+    }
+
+    void addNote(juce::MidiMessageSequence& sequence, int note, double start, double length)
+    {
+        sequence.addEvent(juce::MidiMessage::noteOn(1, note, 0.8f), start);
+        sequence.addEvent(juce::MidiMessage::noteOff(1, note), start + length);
+    }
+
+    // All patterns are at 120bpm
+    juce::MidiMessageSequence makePattern(const juce::String& name, double seconds)
+    {
+        const double beat = 0.5;
+        juce::MidiMessageSequence sequence;
+
+        if (name == "arp") {
+            const int notes[] = { 48, 55, 60, 64, 67, 72, 67, 64 };
+            int step = 0;
+
+            for (double t = 0.0; t < seconds; t += beat / 4.0, step++) {
+                addNote(sequence, notes[step % 8], t, beat / 8.0);
+            }
+        }
+        else if (name == "stress") {
+            // a new note every 16th, each held for two bars, keeps the whole voice pool busy
+            int step = 0;
+
+            for (double t = 0.0; t < seconds; t += beat / 4.0, step++) {
+                addNote(sequence, 36 + (step * 7) % 48, t, beat * 8.0);
+            }
+        }
+        else {
+            const int chords[4][4] = { { 48, 55, 60, 64 }, { 45, 52, 57, 60 }, { 41, 48, 53, 57 }, { 43, 50, 55, 59 } };
+            int bar = 0;
+
+            for (double t = 0.0; t < seconds; t += beat * 4.0, bar++) {
+                for (int note : chords[bar % 4]) {
+                    addNote(sequence, note, t, beat * 4.0 - 0.05);
+                }
+            }
+        }
+
+        sequence.sort();
+        sequence.updateMatchedPairs();
+        return sequence;
+    }
+
+    bool loadMidiFile(const juce::File& file, juce::MidiMessageSequence& sequence)
+    {
+        juce::FileInputStream stream(file);
+        juce::MidiFile midi;
+
+        if (!stream.openedOk() || !midi.readFrom(stream))
+            return false;
+
+        midi.convertTimestampTicksToSeconds();
+
+        for (int track = 0; track < midi.getNumTracks(); track++) {
+            sequence.addSequence(*midi.getTrack(track), 0.0);
+        }
+
+        sequence.updateMatchedPairs();
+        return true;
+    }
+
+    int countActiveVoices(SyrberusAudioProcessor& processor)
+    {
+        int voices, layers;
+        processor.synth.countActive(voices, layers);
+        return voices;
+    }
+
+    RenderStats render(SyrberusAudioProcessor& processor, const RenderSettings& settings,
+                       const juce::MidiMessageSequence& sequence, juce::AudioBuffer<float>& output)
+    {
+        RenderStats stats;
+        const int totalSamples = output.getNumSamples();
+
+        juce::AudioBuffer<float> block(output.getNumChannels(), settings.blockSize);
+        juce::MidiBuffer midi;
+        int nextEvent = 0;
+
+        stats.blockSeconds.reserve((size_t)(totalSamples / settings.blockSize + 1));
+
+        for (int position = 0; position < totalSamples; position += settings.blockSize) {
+            const int numSamples = juce::jmin(settings.blockSize, totalSamples - position);
+            block.setSize(block.getNumChannels(), numSamples, false, false, true);
+            block.clear();
+            midi.clear();
+
+            while (nextEvent < sequence.getNumEvents()) {
+                const auto& message = sequence.getEventPointer(nextEvent)->message;
+                const int sample = (int)std::round(message.getTimeStamp() * settings.sampleRate);
+
+                if (sample >= position + numSamples) break;
+
+                midi.addEvent(message, juce::jmax(0, sample - position));
+                nextEvent++;
+            }
+
+            const auto start = juce::Time::getHighResolutionTicks();
+            processor.processBlock(block, midi);
+            const auto end = juce::Time::getHighResolutionTicks();
+
+            stats.blockSeconds.push_back(juce::Time::highResolutionTicksToSeconds(end - start));
+
+            const int voices = countActiveVoices(processor);
+            stats.voiceBlocks += voices;
+            stats.peakVoices = juce::jmax(stats.peakVoices, voices);
+
+            for (int channel = 0; channel < output.getNumChannels(); channel++) {
+                output.copyFrom(channel, position, block, channel, 0, numSamples);
+            }
+        }
+
+        stats.audioSeconds = totalSamples / settings.sampleRate;
+        return stats;
+    }
+
+    void printReport(const RenderSettings& settings, RenderStats stats)
+    {
+        auto& times = stats.blockSeconds;
+        if (times.empty()) return;
+
+        const double total = std::accumulate(times.begin(), times.end(), 0.0);
+        std::sort(times.begin(), times.end());
+
+        auto micros = [](double seconds) { return juce::String(seconds * 1.0e6, 1) + " us"; };
+        const double budget = settings.blockSize / settings.sampleRate;
+
+        std::cout << "Rendered " << juce::String(stats.audioSeconds, 2) << "s in " << times.size() << " blocks of "
+                  << settings.blockSize << " at " << settings.sampleRate << "Hz\n"
+                  << "  real-time factor: " << juce::String(stats.audioSeconds / total, 1) << "x ("
+                  << juce::String(100.0 * total / stats.audioSeconds, 2) << "% of real time)\n"
+                  << "  block time: min " << micros(times.front())
+                  << ", mean " << micros(total / (double)times.size())
+                  << ", p99 " << micros(times[(size_t)(0.99 * (double)(times.size() - 1))])
+                  << ", max " << micros(times.back())
+                  << " (budget " << micros(budget) << ")\n"
+                  << "  voices rendered: " << stats.voiceBlocks << " voice blocks, mean "
+                  << juce::String((double)stats.voiceBlocks / (double)times.size(), 2)
+                  << ", peak " << stats.peakVoices << "\n";
+    }
+
+    bool writeWav(const juce::File& file, const juce::AudioBuffer<float>& buffer, double sampleRate)
+    {
+        file.deleteFile();
+        auto stream = std::make_unique<juce::FileOutputStream>(file);
+        if (!stream->openedOk()) return false;
+
+        juce::WavAudioFormat wav;
+        std::unique_ptr<juce::AudioFormatWriter> writer(wav.createWriterFor(stream.get(), sampleRate,
+                                                                            (unsigned int)buffer.getNumChannels(), 24, {}, 0));
+        if (writer == nullptr) return false;
+
+        stream.release(); // the writer owns it now
+        return writer->writeFromAudioSampleBuffer(buffer, 0, buffer.getNumSamples());
+    }
+}
+
+int main(int argc, char* argv[])
+{
+    // the parameter tree runs a timer, which needs a message manager
+    juce::ScopedJuceInitialiser_GUI juceInitialiser;
+
+    // everything has a default, so asking for nothing gets the options rather than a render
+    if (argc < 2 || juce::String(argv[1]) == "--help") {
+        printUsage();
+        return 0;
+    }
+
+    RenderSettings settings;
+    if (!parseArguments(argc, argv, settings)) {
+        printUsage();
+        return 1;
+    }
+
+    SyrberusAudioProcessor processor;
+
+    if (settings.library != juce::File() && !processor.openPresetLibrary(settings.library)) {
+        std::cerr << "Could not open preset library " << settings.library.getFullPathName() << "\n";
+        return 1;
+    }
+
+    if (settings.libraryPreset.isNotEmpty() && !processor.loadPreset(settings.libraryPreset)) {
+        std::cerr << "No preset called " << settings.libraryPreset << " in the library\n";
+        return 1;
+    }
+
+    if (settings.preset != juce::File() && !loadPreset(processor, settings.preset)) {
+        std::cerr << "Could not read preset " << settings.preset.getFullPathName() << "\n";
+        return 1;
+    }
+
+    if (!applyOverrides(processor, settings.overrides))
+        return 1;
+
+    if (settings.dumpPreset != juce::File()) {
+        if (auto xml = processor.apvts.copyState().createXml())
+            xml->writeTo(settings.dumpPreset);
+    }
+
+    juce::MidiMessageSequence sequence;
+    if (settings.midiFile != juce::File()) {
+        if (!loadMidiFile(settings.midiFile, sequence)) {
+            std::cerr << "Could not read MIDI file " << settings.midiFile.getFullPathName() << "\n";
+            return 1;
+        }
+    } else {
+        sequence = makePattern(settings.pattern, settings.patternSeconds);
+    }
+
+    processor.setNonRealtime(settings.offline);
+    processor.setRateAndBufferSizeDetails(settings.sampleRate, settings.blockSize);
+    processor.prepareToPlay(settings.sampleRate, settings.blockSize);
+
+    const int totalSamples = (int)std::ceil((sequence.getEndTime() + settings.tailSeconds) * settings.sampleRate);
+    juce::AudioBuffer<float> output(processor.getTotalNumOutputChannels(), juce::jmax(1, totalSamples));
+
+    auto stats = render(processor, settings, sequence, output);
+    processor.releaseResources();
+
+    printReport(settings, stats);
+
+    if (settings.output != juce::File() && !writeWav(settings.output, output, settings.sampleRate)) {
+        std::cerr << "Could not write " << settings.output.getFullPathName() << "\n";
+        return 1;
+    }
+
+    return 0;
+}
@@ -0,0 +1,35 @@
+/*
+  ==============================================================================
+
+    Main.cpp
+    Created: 18 Oct 2026 4:22:51am
+    Author:  Norb
+
+    Runs the engine's juce::UnitTests without a host. Exits with 1 if any of
+    them failed, so it can gate a build.
+
+  ==============================================================================
+*/
+
+#include <JuceHeader.h>
+
+int main(int argc, char* argv[])
+{
+    // the parameter tree runs a timer, which needs a message manager
+    juce::ScopedJuceInitialiser_GUI juceInitialiser;
+
+    juce::UnitTestRunner runner;
+    runner.setAssertOnFailure(false);
+
+    if (argc > 1)
+        runner.runTests({ juce::UnitTest::getTestsWithName(argv[1]) });
+    else
+        runner.runTestsInCategory("Syrberus");
+
+    int failures = 0;
+    for (int i = 0; i < runner.getNumResults(); i++) {
+        failures += runner.getResult(i)->failures;
+    }
+
+    return failures > 0 ? 1 : 0;
+}
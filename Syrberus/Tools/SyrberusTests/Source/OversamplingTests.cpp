@@ -0,0 +1,96 @@
+/*
+  ==============================================================================
+
+    OversamplingTests.cpp
+    Created: 18 Oct 2026 4:22:51am
+    Author:  Norb
+
+  ==============================================================================
+*/
+
+#include <JuceHeader.h>
+#include "../../../Source/PluginProcessor.h"
+#include "../../../Source/Parameters.h"
+
+namespace {
+    constexpr double SAMPLE_RATE = 48000.0;
+    constexpr int BLOCK_SIZE = 256;
+
+    void setParameter(SyrberusAudioProcessor& processor, const char* id, float value)
+    {
+        auto* param = processor.apvts.getParameter(id);
+        param->setValueNotifyingHost(param->convertTo0to1(value));
+    }
+
+    // Largest step between neighbouring samples of output[start, end)
+    float largestStep(const std::vector<float>& output, size_t start, size_t end)
+    {
+        float largest = 0.0f;
+        for (size_t i = juce::jmax((size_t)1, start); i < end; i++) {
+            largest = juce::jmax(largest, std::abs(output[i] - output[i - 1]));
+        }
+        return largest;
+    }
+}
+
+/*
+ * Hosts flip isNonRealtime around bounces and freezes while notes ring, and the
+ * default profiles (Off live, 4x offline) change the oversampling when they do.
+ * A sounding voice has to carry on as it was, the new rate waits for its next note.
+*/
+class OversamplingTests : public juce::UnitTest {
+public:
+    OversamplingTests() : juce::UnitTest("Oversampling profile switch", "Syrberus") {}
+
+    void runTest() override
+    {
+        beginTest("A held note stays continuous across realtime -> offline -> realtime");
+
+        SyrberusAudioProcessor processor;
+
+        // one plain sine, at full level straight away
+        setParameter(processor, Params::envAttack, 0.0f);
+        setParameter(processor, Params::envSustain, 1.0f);
+        setParameter(processor, Params::osc2Mix, 0.0f);
+        setParameter(processor, Params::osc3Mix, 0.0f);
+        setParameter(processor, Params::miscOversampling, 0.0f);
+        setParameter(processor, Params::miscOversamplingOffline, 2.0f);
+
+        processor.setNonRealtime(false);
+        processor.setRateAndBufferSizeDetails(SAMPLE_RATE, BLOCK_SIZE);
+        processor.prepareToPlay(SAMPLE_RATE, BLOCK_SIZE);
+
+        const int blocksPerProfile = 40;
+        std::vector<float> output;
+        juce::AudioBuffer<float> block(processor.getTotalNumOutputChannels(), BLOCK_SIZE);
+        juce::MidiBuffer midi;
+
+        for (int b = 0; b < 3 * blocksPerProfile; b++) {
+            processor.setNonRealtime(b >= blocksPerProfile && b < 2 * blocksPerProfile);
+
+            block.clear();
+            midi.clear();
+            if (b == 0) midi.addEvent(juce::MidiMessage::noteOn(1, 57, 0.8f), 0);
+
+            processor.processBlock(block, midi);
+            output.insert(output.end(), block.getReadPointer(0), block.getReadPointer(0) + BLOCK_SIZE);
+        }
+
+        processor.releaseResources();
+
+        auto blockStart = [](int b) { return (size_t)(b * BLOCK_SIZE); };
+
+        // a settled stretch of the sine before any switch, well after the gain smoothing
+        const float steady = largestStep(output, blockStart(10), blockStart(blocksPerProfile - 1));
+        expect(steady > 0.001f, "the note should be sounding");
+
+        // a restarted oscillator jumps by up to the sine's whole amplitude
+        for (int switchBlock : { blocksPerProfile, 2 * blocksPerProfile }) {
+            const float around = largestStep(output, blockStart(switchBlock - 1), blockStart(switchBlock + 2));
+            expectLessOrEqual(around, steady * 1.1f + 1.0e-4f,
+                              "discontinuity at the profile switch in block " + juce::String(switchBlock));
+        }
+    }
+};
+
+static OversamplingTests oversamplingTests;